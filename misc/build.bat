@@ -4,6 +4,8 @@ setlocal EnableDelayedExpansion
 set ATmega2560_COM=3
 set ATmega32U4_COM=4
 set ATmega32U4_bootloader_COM=5
+set MOUSE_USART_SPI=0
+set MOUSE_PACKET_VERSION=1
 set WARNINGS= ^
 	-Werror -Wall -Wextra -Wpedantic -Wwrite-strings -fmax-errors=1 ^
 	-Wno-unused-label -Wno-unused-variable -Wno-unused-parameter -Wno-unused-function -Wno-unused-but-set-variable
@@ -15,7 +17,18 @@ if not exist W:\build\ (
 pushd W:\build\
 	for /f "tokens=2delims=COM:" %%i in ('mode ^| findstr /RC:"\C\O\M[0-9*]"') do set "com=%%i"
 
-	avr-gcc %WARNINGS% -Os -DF_CPU=16000000 -mmcu=atmega2560 -I W:\deps\FatFs\source\ -c W:\src\ATmega2560_TheMachine.c
+	set FLASH_BANK=0
+	set FLASH_BANK_OBJECT=
+	if exist W:\misc\FLASH.BIN (
+		set FLASH_BANK=1
+		set FLASH_BANK_OBJECT=ATmega2560_flash_bank.o
+		avr-gcc -mmcu=atmega2560 -Wa,-I,W:\misc\ -c W:\src\ATmega2560_flash_bank.S
+		if !ERRORLEVEL! neq 0 (
+			goto ABORT
+		)
+	)
+
+	avr-gcc %WARNINGS% -Os -DF_CPU=16000000 -DFLASH_BANK=!FLASH_BANK! -DMOUSE_USART_SPI=%MOUSE_USART_SPI% -DMOUSE_PACKET_VERSION=%MOUSE_PACKET_VERSION% -mmcu=atmega2560 -I W:\deps\FatFs\source\ -c W:\src\ATmega2560_TheMachine.c
 	if !ERRORLEVEL! neq 0 (
 		goto ABORT
 	)
@@ -26,11 +39,14 @@ REM		goto ABORT
 REM	)
 
 	if !com! == !ATmega2560_COM! (
-		avr-gcc -DF_CPU=16000000 -mmcu=atmega2560 -o ATmega2560_TheMachine.elf ATmega2560_TheMachine.o
+		avr-gcc -DF_CPU=16000000 -mmcu=atmega2560 -o ATmega2560_TheMachine.elf ATmega2560_TheMachine.o !FLASH_BANK_OBJECT!
 		if !ERRORLEVEL! neq 0 (
 			goto ABORT
 		)
 
+		REM The "Data" figure is the statics, and what's left of the 8 KiB is all the stack gets.
+		avr-size --format=avr --mcu=atmega2560 ATmega2560_TheMachine.elf
+
 		avr-objcopy -O ihex ATmega2560_TheMachine.elf ATmega2560_TheMachine.hex
 		if !ERRORLEVEL! neq 0 (
 			goto ABORT
@@ -0,0 +1,254 @@
+// Host program that makes "FLASH.BIN", the part of the dictionary that gets built into the ATmega2560's flash.
+// It's laid out like the buckets of "BANK.BIN", so the same search goes through it, just without the SD card.
+// Whole lengths are put in or left out so that a length in flash never has to be looked up on the SD card too.
+// The Anagrams lengths go first, then the longest WordHunt lengths (which are worth the most points) for as long as they fit.
+//
+// Build : gcc -std=c11 -O2 -o make_flash_bank make_flash_bank.c
+// Usage : make_flash_bank WORDS.TXT FLASH.BIN [BUDGET_BYTES]
+//
+// Refer to:
+// - `FLASH_BANK_MAGIC` and the rest of the "FLASH.BIN" defines in "ATmega2560_TheMachine.c".
+// - "ATmega2560_flash_bank.S", which puts "FLASH.BIN" into flash.
+// - The "WORDS.TXT" tokenizer and the "BANK.BIN" writer in `init_bank_bin`, which this has to agree with.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include "../src/basic.h"
+
+// These must be the same as in "ATmega2560_TheMachine.c".
+#define MIN_LETTERS                  3
+#define ANAGRAMS_MAX_LETTERS         6
+#define ABSOLUTE_MAX_LETTERS         16
+#define BANK_BUCKET_COUNT            ((ABSOLUTE_MAX_LETTERS - MIN_LETTERS + 1) * 26)
+#define BANK_BUCKET_INDEX(L, I)      ((ABSOLUTE_MAX_LETTERS - (L)) * 26 + (I) - 'a')
+#define WORD_SIGNATURE_REPEATS_SHIFT 26
+#define FLASH_BANK_MAGIC             0x48534C46UL // "FLSH" when read as bytes.
+#define FLASH_BANK_VERSION           1
+#define FLASH_BANK_HEADER_SIZE       (sizeof(u32) + sizeof(u16) + sizeof(u32) + (BANK_BUCKET_COUNT + 1) * sizeof(u32))
+#define COMPRESSED_WORD_TAIL_LENGTH_FROM_WORD_LENGTH(WORD_LENGTH) ((((WORD_LENGTH) - 1) * 5 + ((WORD_LENGTH - 1) + 2) / 3 + 7) / 8)
+#define BANK_RECORD_SIZE(WORD_LENGTH) (sizeof(u32) + COMPRESSED_WORD_TAIL_LENGTH_FROM_WORD_LENGTH(WORD_LENGTH))
+#define DEFAULT_BUDGET               (192UL * 1024) // Leaves the rest of the 256 KiB for the program.
+
+struct Word
+{
+	u8  letters[ABSOLUTE_MAX_LETTERS];
+	u8  length;
+	u32 order;                                       // Where it was in "WORDS.TXT", so sorting keeps "WORDS.TXT" order within a sub-bucket.
+};
+
+static int
+compare_words(const void* a, const void* b) // Same order as "BANK.BIN": descending length, then initial, then second letter.
+{
+	const struct Word* x = a;
+	const struct Word* y = b;
+	if (x->length     != y->length    ) return x->length     > y->length     ? -1 : 1;
+	if (x->letters[0] != y->letters[0]) return x->letters[0] < y->letters[0] ? -1 : 1;
+	if (x->letters[1] != y->letters[1]) return x->letters[1] < y->letters[1] ? -1 : 1;
+	return x->order < y->order ? -1 : x->order > y->order;
+}
+
+static u32 // Same as `get_word_signature` on the ATmega2560.
+get_word_signature(const u8* letters, u8 letter_count)
+{
+	u32 signature = 0;
+	for (u8 i = 0; i < letter_count; i += 1)
+	{
+		if (signature & (1UL << (letters[i] - 'a')))
+		{
+			signature += 1UL << WORD_SIGNATURE_REPEATS_SHIFT;
+		}
+		else
+		{
+			signature |= 1UL << (letters[i] - 'a');
+		}
+	}
+	return signature;
+}
+
+static void
+write_u16(FILE* file, u16 value)
+{
+	fputc(value & 0xFF, file);
+	fputc(value >> 8  , file);
+}
+
+static void
+write_u32(FILE* file, u32 value)
+{
+	write_u16(file, value & 0xFFFF);
+	write_u16(file, value >> 16);
+}
+
+int
+main(int argc, char** argv)
+{
+	if (argc != 3 && argc != 4)
+	{
+		fprintf(stderr, "Usage: %s WORDS.TXT FLASH.BIN [BUDGET_BYTES]\n", argv[0]);
+		return 1;
+	}
+	u32 budget = argc == 4 ? strtoul(argv[3], 0, 10) : DEFAULT_BUDGET;
+
+	//
+	// Get every word that would end up in "BANK.BIN".
+	//
+
+	FILE* words_file = fopen(argv[1], "rb");
+	if (!words_file)
+	{
+		fprintf(stderr, "Could not read \"%s\".\n", argv[1]);
+		return 1;
+	}
+
+	struct Word* words         = 0;
+	u32          word_count    = 0;
+	u32          word_capacity = 0;
+	u32          length_sizes[ABSOLUTE_MAX_LETTERS + 1] = {0}; // Bytes that all the words of a length take up.
+	{
+		u8    buffer[ABSOLUTE_MAX_LETTERS];
+		u8    length = 0;
+		bool8 valid  = true;
+		for (int character = 0; character != EOF;)
+		{
+			character = fgetc(words_file);
+			if ('A' <= character && character <= 'Z')
+			{
+				character += 'a' - 'A';
+			}
+
+			if ('a' <= character && character <= 'z')
+			{
+				if (length < countof(buffer))
+				{
+					buffer[length] = character;
+				}
+				if (length < 0xFF)
+				{
+					length += 1;
+				}
+			}
+			else if (character <= ' ') // Includes `EOF`.
+			{
+				if (valid && MIN_LETTERS <= length && length <= ABSOLUTE_MAX_LETTERS)
+				{
+					if (word_count == word_capacity)
+					{
+						word_capacity = word_capacity ? word_capacity * 2 : 4096;
+						words         = realloc(words, word_capacity * sizeof(struct Word));
+						if (!words)
+						{
+							fprintf(stderr, "Out of memory.\n");
+							return 1;
+						}
+					}
+
+					struct Word* word = &words[word_count];
+					memset(word, 0, sizeof(*word));
+					memcpy(word->letters, buffer, length);
+					word->length  = length;
+					word->order   = word_count;
+					word_count   += 1;
+
+					length_sizes[length] += BANK_RECORD_SIZE(length);
+				}
+
+				length = 0;
+				valid  = true;
+			}
+			else
+			{
+				valid = false;
+			}
+		}
+	}
+	fclose(words_file);
+
+	qsort(words, word_count, sizeof(struct Word), compare_words);
+
+	//
+	// Pick the lengths.
+	//
+
+	u32 length_mask = 0;
+	u32 total_size  = FLASH_BANK_HEADER_SIZE;
+	for (u8 i = 0; i < ABSOLUTE_MAX_LETTERS - MIN_LETTERS + 1; i += 1)
+	{
+		u8 length = i < ANAGRAMS_MAX_LETTERS - MIN_LETTERS + 1
+			? ANAGRAMS_MAX_LETTERS - i
+			: ABSOLUTE_MAX_LETTERS - (i - (ANAGRAMS_MAX_LETTERS - MIN_LETTERS + 1));
+		if (total_size + length_sizes[length] <= budget)
+		{
+			length_mask |= 1UL << length;
+			total_size  += length_sizes[length];
+			printf("%2u letters: %7u bytes.\n", length, (unsigned) length_sizes[length]);
+		}
+		else
+		{
+			printf("%2u letters: %7u bytes, left for the SD card.\n", length, (unsigned) length_sizes[length]);
+		}
+	}
+
+	//
+	// Write out the header and then the buckets.
+	//
+
+	FILE* flash_file = fopen(argv[2], "wb");
+	if (!flash_file)
+	{
+		fprintf(stderr, "Could not create \"%s\".\n", argv[2]);
+		return 1;
+	}
+
+	write_u32(flash_file, FLASH_BANK_MAGIC);
+	write_u16(flash_file, FLASH_BANK_VERSION);
+	write_u32(flash_file, length_mask);
+
+	u32 offset = FLASH_BANK_HEADER_SIZE;
+	for (u8 length = ABSOLUTE_MAX_LETTERS; length >= MIN_LETTERS; length -= 1)
+	{
+		for (u8 initial = 'a'; initial <= 'z'; initial += 1)
+		{
+			write_u32(flash_file, offset);
+			if (length_mask & (1UL << length))
+			{
+				for (u32 i = 0; i < word_count; i += 1)
+				{
+					if (words[i].length == length && words[i].letters[0] == initial)
+					{
+						offset += BANK_RECORD_SIZE(length);
+					}
+				}
+			}
+		}
+	}
+	write_u32(flash_file, offset);
+
+	for (u32 i = 0; i < word_count; i += 1)
+	{
+		if (length_mask & (1UL << words[i].length))
+		{
+			u16 tail[(COMPRESSED_WORD_TAIL_LENGTH_FROM_WORD_LENGTH(ABSOLUTE_MAX_LETTERS) + 1) / 2] = {0};
+			for (u8 j = 0; j < words[i].length - 1; j += 1)
+			{
+				tail[j / 3] |= (words[i].letters[1 + j] - 'a') << ((j % 3) * 5);
+			}
+
+			write_u32(flash_file, get_word_signature(words[i].letters, words[i].length));
+			for (u8 j = 0; j < COMPRESSED_WORD_TAIL_LENGTH_FROM_WORD_LENGTH(words[i].length); j += 1)
+			{
+				fputc((tail[j / 2] >> ((j % 2) * 8)) & 0xFF, flash_file);
+			}
+		}
+	}
+
+	if (ferror(flash_file) || fclose(flash_file))
+	{
+		fprintf(stderr, "Failed to write \"%s\".\n", argv[2]);
+		return 1;
+	}
+
+	printf("Wrote %u bytes.\n", (unsigned) total_size);
+	return 0;
+}
@@ -0,0 +1,409 @@
+// Host program that makes "RACKS.BIN" for the Anagrams lookup in "ATmega2560_TheMachine.c".
+// Every sorted rack of six letters is mapped to the words that can be made out of it, longest first, along with which tiles to use.
+//
+// Build : gcc -std=c11 -O2 -o make_racks make_racks.c
+// Usage : make_racks WORDS.TXT RACKS.BIN
+//
+// Refer to:
+// - `RACKS_BIN_MAGIC` and the rest of the "RACKS.BIN" defines in "ATmega2560_TheMachine.c".
+// - The "WORDS.TXT" tokenizer in `init_bank_bin`, which this has to agree with so that the bank indices line up with "BANK.BIN".
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include "../src/basic.h"
+
+// These must be the same as in "ATmega2560_TheMachine.c".
+#define MIN_LETTERS          3
+#define ANAGRAMS_MAX_LETTERS 6
+#define ABSOLUTE_MAX_LETTERS 16
+#define RACKS_BIN_MAGIC      0x4B434152UL // "RACK" when read as bytes.
+#define RACKS_BIN_VERSION    2
+#define RACK_COUNT           736281       // Multisets of six letters, which is C(26 + 6 - 1, 6).
+
+struct Word
+{
+	u8  letters[ANAGRAMS_MAX_LETTERS];
+	u8  length;
+	u16 bank_index;
+	u32 key;                              // The letters sorted and then packed in base 27 so that anagrams have the same key.
+};
+
+struct Answer
+{
+	const struct Word* word;
+	u8                 tiles[ANAGRAMS_MAX_LETTERS];
+};
+
+static u32
+get_key(const u8* sorted_letters, u8 length)
+{
+	u32 key = 0;
+	for (u8 i = 0; i < length; i += 1)
+	{
+		key = key * 27 + (sorted_letters[i] - 'a' + 1);
+	}
+	return key;
+}
+
+static int
+compare_words(const void* a, const void* b)
+{
+	const struct Word* x = a;
+	const struct Word* y = b;
+	if (x->key != y->key)
+	{
+		return x->key < y->key ? -1 : 1;
+	}
+	return memcmp(x->letters, y->letters, ANAGRAMS_MAX_LETTERS);
+}
+
+static int
+compare_answers(const void* a, const void* b) // Longest first like the other searches, then alphabetically.
+{
+	const struct Word* x = ((const struct Answer*) a)->word;
+	const struct Word* y = ((const struct Answer*) b)->word;
+	if (x->length != y->length)
+	{
+		return x->length > y->length ? -1 : 1;
+	}
+	return memcmp(x->letters, y->letters, ANAGRAMS_MAX_LETTERS);
+}
+
+static int
+compare_keys(const void* a, const void* b)
+{
+	u32 x = *(const u32*) a;
+	u32 y = *(const u32*) b;
+	return x < y ? -1 : x > y;
+}
+
+static u32 // Same as `get_rack_rank` on the ATmega2560.
+get_rack_rank(const u8* sorted_letters)
+{
+	u32 rank = 0;
+	for (u8 i = 0; i < ANAGRAMS_MAX_LETTERS; i += 1)
+	{
+		u32 binomial = 1;
+		u8  n        = sorted_letters[i] - 'a' + i;
+		for (u8 j = 0; j < i + 1; j += 1)
+		{
+			binomial = binomial * (n - j) / (j + 1);
+		}
+		rank += binomial;
+	}
+	return rank;
+}
+
+static void
+write_u16(FILE* file, u16 value)
+{
+	fputc(value & 0xFF, file);
+	fputc(value >> 8  , file);
+}
+
+static void
+write_u32(FILE* file, u32 value)
+{
+	write_u16(file, value & 0xFFFF);
+	write_u16(file, value >> 16);
+}
+
+int
+main(int argc, char** argv)
+{
+	if (argc != 3)
+	{
+		fprintf(stderr, "Usage: %s WORDS.TXT RACKS.BIN\n", argv[0]);
+		return 1;
+	}
+
+	//
+	// Get the words that fit in a rack along with where they are in "BANK.BIN".
+	//
+
+	FILE* words_file = fopen(argv[1], "rb");
+	if (!words_file)
+	{
+		fprintf(stderr, "Could not read \"%s\".\n", argv[1]);
+		return 1;
+	}
+
+	struct Word* words          = 0;
+	u32          word_count     = 0;
+	u32          word_capacity  = 0;
+	u16          sub_bucket_sizes[ABSOLUTE_MAX_LETTERS + 1][26][26] = {{{0}}}; // "BANK.BIN" groups a bucket's words by their second letter.
+	{
+		u8    buffer[ABSOLUTE_MAX_LETTERS];
+		u8    length = 0;
+		bool8 valid  = true;
+		for (int character = 0; character != EOF;)
+		{
+			character = fgetc(words_file);
+			if ('A' <= character && character <= 'Z')
+			{
+				character += 'a' - 'A';
+			}
+
+			if ('a' <= character && character <= 'z')
+			{
+				if (length < countof(buffer))
+				{
+					buffer[length] = character;
+				}
+				if (length < 0xFF)
+				{
+					length += 1;
+				}
+			}
+			else if (character <= ' ') // Includes `EOF`.
+			{
+				if (valid && MIN_LETTERS <= length && length <= ABSOLUTE_MAX_LETTERS)
+				{
+					u16 bank_index = sub_bucket_sizes[length][buffer[0] - 'a'][buffer[1] - 'a']; // Only within the sub-bucket for now.
+					sub_bucket_sizes[length][buffer[0] - 'a'][buffer[1] - 'a'] += 1;
+
+					if (length <= ANAGRAMS_MAX_LETTERS)
+					{
+						if (word_count == word_capacity)
+						{
+							word_capacity = word_capacity ? word_capacity * 2 : 4096;
+							words         = realloc(words, word_capacity * sizeof(struct Word));
+							if (!words)
+							{
+								fprintf(stderr, "Out of memory.\n");
+								return 1;
+							}
+						}
+
+						struct Word* word = &words[word_count];
+						memset(word, 0, sizeof(*word));
+						memcpy(word->letters, buffer, length);
+						word->length     = length;
+						word->bank_index = bank_index;
+
+						u8 sorted_letters[ANAGRAMS_MAX_LETTERS];
+						memcpy(sorted_letters, buffer, length);
+						for (u8 i = 1; i < length; i += 1)
+						{
+							for (u8 j = i; j && sorted_letters[j - 1] > sorted_letters[j]; j -= 1)
+							{
+								u8 swap               = sorted_letters[j];
+								sorted_letters[j]     = sorted_letters[j - 1];
+								sorted_letters[j - 1] = swap;
+							}
+						}
+						word->key = get_key(sorted_letters, length);
+
+						word_count += 1;
+					}
+				}
+
+				length = 0;
+				valid  = true;
+			}
+			else
+			{
+				valid = false;
+			}
+		}
+	}
+	fclose(words_file);
+
+	for (u32 i = 0; i < word_count; i += 1) // Move each index past the sub-buckets that come before it in the bucket.
+	{
+		for (u8 second_index = 0; second_index < words[i].letters[1] - 'a'; second_index += 1)
+		{
+			words[i].bank_index += sub_bucket_sizes[words[i].length][words[i].letters[0] - 'a'][second_index];
+		}
+	}
+
+	qsort(words, word_count, sizeof(struct Word), compare_words);
+	{ // Duplicates keep the first one, which is the one the trie and searches use.
+		u32 kept_count = 0;
+		for (u32 i = 0; i < word_count; i += 1)
+		{
+			if (!kept_count || compare_words(&words[kept_count - 1], &words[i]))
+			{
+				words[kept_count]  = words[i];
+				kept_count        += 1;
+			}
+			else if (words[kept_count - 1].bank_index > words[i].bank_index)
+			{
+				words[kept_count - 1].bank_index = words[i].bank_index;
+			}
+		}
+		word_count = kept_count;
+	}
+
+	//
+	// Write out each rack's answers in order of their rank.
+	//
+
+	FILE* racks_file = fopen(argv[2], "wb");
+	if (!racks_file)
+	{
+		fprintf(stderr, "Could not create \"%s\".\n", argv[2]);
+		return 1;
+	}
+
+	u32* answer_offsets = malloc((RACK_COUNT + 1) * sizeof(u32));
+	if (!answer_offsets)
+	{
+		fprintf(stderr, "Out of memory.\n");
+		return 1;
+	}
+
+	u32 header_size = sizeof(u32) + sizeof(u16) + (RACK_COUNT + 1) * sizeof(u32);
+	if (fseek(racks_file, header_size, SEEK_SET))
+	{
+		fprintf(stderr, "Failed to seek \"%s\".\n", argv[2]);
+		return 1;
+	}
+
+	u32 offset     = header_size;
+	u8  digits[ANAGRAMS_MAX_LETTERS]; // Strictly increasing, and the rack is `digits[i] - i`. Going through them in colexicographic order goes through the ranks in order.
+	for (u8 i = 0; i < ANAGRAMS_MAX_LETTERS; i += 1)
+	{
+		digits[i] = i;
+	}
+
+	for (u32 rank = 0; rank < RACK_COUNT; rank += 1)
+	{
+		u8 rack[ANAGRAMS_MAX_LETTERS];
+		for (u8 i = 0; i < ANAGRAMS_MAX_LETTERS; i += 1)
+		{
+			rack[i] = 'a' + digits[i] - i;
+		}
+		if (get_rack_rank(rack) != rank)
+		{
+			fprintf(stderr, "Rack enumeration doesn't agree with `get_rack_rank`.\n");
+			return 1;
+		}
+
+		//
+		// Every distinct sub-rack of legal length is looked up as a key.
+		//
+
+		u32 keys[1 << ANAGRAMS_MAX_LETTERS];
+		u8  key_count = 0;
+		for (u8 subset = 1; subset < (1 << ANAGRAMS_MAX_LETTERS); subset += 1)
+		{
+			u8 letters[ANAGRAMS_MAX_LETTERS];
+			u8 length = 0;
+			for (u8 i = 0; i < ANAGRAMS_MAX_LETTERS; i += 1)
+			{
+				if (subset & (1 << i))
+				{
+					letters[length]  = rack[i];
+					length          += 1;
+				}
+			}
+			if (length >= MIN_LETTERS)
+			{
+				keys[key_count]  = get_key(letters, length);
+				key_count       += 1;
+			}
+		}
+		qsort(keys, key_count, sizeof(u32), compare_keys);
+
+		struct Answer answers[4096];
+		u32           answer_count = 0;
+		for (u8 key_index = 0; key_index < key_count; key_index += 1)
+		{
+			if (key_index && keys[key_index] == keys[key_index - 1])
+			{
+				continue;
+			}
+
+			u32 low  = 0; // Binary search for the first word with the key.
+			u32 high = word_count;
+			while (low < high)
+			{
+				u32 middle = (low + high) / 2;
+				if (words[middle].key < keys[key_index])
+				{
+					low = middle + 1;
+				}
+				else
+				{
+					high = middle;
+				}
+			}
+
+			for (u32 i = low; i < word_count && words[i].key == keys[key_index]; i += 1)
+			{
+				if (answer_count == countof(answers))
+				{
+					fprintf(stderr, "Too many answers for a rack.\n");
+					return 1;
+				}
+
+				struct Answer* answer = &answers[answer_count];
+				answer->word = &words[i];
+
+				u8 used = 0;
+				for (u8 j = 0; j < words[i].length; j += 1)
+				{
+					for (u8 k = 0; k < ANAGRAMS_MAX_LETTERS; k += 1)
+					{
+						if (!(used & (1 << k)) && rack[k] == words[i].letters[j])
+						{
+							used           |= 1 << k;
+							answer->tiles[j] = k;
+							break;
+						}
+					}
+				}
+
+				answer_count += 1;
+			}
+		}
+		qsort(answers, answer_count, sizeof(struct Answer), compare_answers);
+
+		answer_offsets[rank] = offset;
+		for (u32 i = 0; i < answer_count; i += 1)
+		{
+			fputc(answers[i].word->length, racks_file);
+			write_u16(racks_file, answers[i].word->bank_index);
+			fwrite(answers[i].tiles, 1, answers[i].word->length, racks_file);
+			offset += sizeof(u8) + sizeof(u16) + answers[i].word->length;
+		}
+
+		//
+		// Go to the next rack in colexicographic order.
+		//
+
+		for (u8 i = 0; i < ANAGRAMS_MAX_LETTERS; i += 1)
+		{
+			if (i == ANAGRAMS_MAX_LETTERS - 1 || digits[i] + 1 < digits[i + 1])
+			{
+				digits[i] += 1;
+				for (u8 j = 0; j < i; j += 1)
+				{
+					digits[j] = j;
+				}
+				break;
+			}
+		}
+	}
+	answer_offsets[RACK_COUNT] = offset;
+
+	rewind(racks_file);
+	write_u32(racks_file, RACKS_BIN_MAGIC);
+	write_u16(racks_file, RACKS_BIN_VERSION);
+	for (u32 i = 0; i < RACK_COUNT + 1; i += 1)
+	{
+		write_u32(racks_file, answer_offsets[i]);
+	}
+
+	if (ferror(racks_file) || fclose(racks_file))
+	{
+		fprintf(stderr, "Failed to write \"%s\".\n", argv[2]);
+		return 1;
+	}
+
+	printf("Wrote %u words into %u racks (%u bytes).\n", (unsigned) word_count, (unsigned) RACK_COUNT, (unsigned) offset);
+	return 0;
+}
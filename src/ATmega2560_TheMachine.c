@@ -1,8 +1,10 @@
 #include <avr/io.h>
 #include <avr/pgmspace.h>
 #include <avr/interrupt.h>
+#include <util/atomic.h>
 #include <util/delay.h>
 #include <stdint.h>
+#include <stddef.h>
 #include <string.h>
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Woverflow"
@@ -45,6 +47,39 @@
 	while (false)
 #define PROC_ABORT(REASON) return PSTR("[" __FILE__ ":" STRINGIFY(__LINE__) "] " REASON "\n")
 
+//
+// The RAM between the statics and the top of the stack is painted right after reset. Whatever paint is still left later on
+// is how close the stack has come to running into the statics, which nothing else would catch.
+//
+
+#define STACK_PAINT 0xC5
+
+extern u8 _end;    // Just past the statics, as placed by the linker.
+extern u8 __stack; // Last byte of RAM, where the stack starts and grows down from.
+
+static __attribute__((naked, used, section(".init3"))) void // Falls through from the startup code once the stack pointer is set, so nothing is on the stack yet.
+_paint_stack(void)
+{
+	for (u8* byte = &_end; byte <= &__stack; byte += 1)
+	{
+		*byte = STACK_PAINT;
+	}
+}
+
+static void
+report_stack(void)
+{
+	const u8* byte = &_end;
+	while (byte < &__stack && *byte == STACK_PAINT)
+	{
+		byte += 1;
+	}
+
+	uart_send_pstr("Stack has come within ");
+	uart_send_u64(byte - &_end);
+	uart_send_pstr(" bytes of the statics.\n");
+}
+
 // TheMachine depends heavily on these defines. Changing them can cause unexpected errors.
 // Refer to:
 // - `decompress_word`
@@ -54,18 +89,168 @@
 #define WORDHUNT_MAX_LETTERS (WORDHUNT_DIMS * WORDHUNT_DIMS)
 #define ABSOLUTE_MAX_LETTERS (ANAGRAMS_MAX_LETTERS > WORDHUNT_MAX_LETTERS ? ANAGRAMS_MAX_LETTERS : WORDHUNT_MAX_LETTERS)
 
+#define ANAGRAMS_LENGTH_MASK      (((1UL << (ANAGRAMS_MAX_LETTERS + 1)) - 1) & ~((1UL << MIN_LETTERS) - 1)) // Bit for each length Anagrams looks for.
+#define WORDHUNT_SCAN_MAX_LETTERS 9 // Longest word that WordHunt looks for when there's no "TRIE.BIN" and every word of "BANK.BIN" has to be tried against the grid.
+#define WORDHUNT_PLAN_SIZE        384  // Bytes of found words that are held onto so they can be played in a better order.
+#define WORDHUNT_PLAN_MAX_WORDS   48
+#define WORDHUNT_PLAN_MAX_ENDS    4    // Start and end cells of the different paths of a word that the planner gets to choose from.
+#define WORDHUNT_PLAN_MIN_WORDS   8    // Planned words needed before they're played early because the mouse has nothing else to do.
+#define WORDHUNT_NO_CELL          0xFF
+#define ANAGRAMS_GAME_MS          60000UL
+#define WORDHUNT_GAME_MS          80000UL
+
 #define DIRECTIONS_COUNT 8
 static const i8 DIRECTIONS_X[DIRECTIONS_COUNT] PROGMEM = { -1,  0,  1, -1, 1, -1, 0, 1 };
 static const i8 DIRECTIONS_Y[DIRECTIONS_COUNT] PROGMEM = { -1, -1, -1,  0, 0,  1, 1, 1 };
 #define get_direction_dx(INDEX) ((i8) pgm_read_byte(&DIRECTIONS_X[INDEX]))
 #define get_direction_dy(INDEX) ((i8) pgm_read_byte(&DIRECTIONS_Y[INDEX]))
 
-typedef u16 InitialCounts[ABSOLUTE_MAX_LETTERS - MIN_LETTERS + 1]['z' - 'a' + 1]; // Words are sorted descending length.
+struct WordHuntBoard // Bitboards of the grid where bit `y * WORDHUNT_DIMS + x` is the cell at `(x, y)`.
+{
+	u16 neighbor_masks[WORDHUNT_MAX_LETTERS]; // Cells that are a step away from the cell.
+	u16 letter_cells['z' - 'a' + 1];          // Cells that have the letter.
+	u8  cell_letters[WORDHUNT_MAX_LETTERS];   // Letter of the cell as `0` to `25`.
+};
+
+struct WordHuntPaths // Goes through the paths on `scratch.wordhunt_board` that spell out a word.
+{
+	u8  cells        [WORDHUNT_MAX_LETTERS]; // Cell of each letter of the word so far.
+	u16 untried_cells[WORDHUNT_MAX_LETTERS]; // Cells that could still be tried for each letter.
+	u16 visited_cells;
+	u8  depth;
+};
+
+struct WordHuntPlan // Words that have been found but not played yet, so the cursor can be sent from one to the next the shortest way.
+{
+	u8  bytes[WORDHUNT_PLAN_SIZE];              // Each word is its length, its count of ends, the ends as `(start_cell << 4) | end_cell`, and then its letters.
+	u16 word_offsets[WORDHUNT_PLAN_MAX_WORDS];
+	u16 size;
+	u8  word_count;
+	u8  cursor_cell;                            // Where the last played word left the cursor.
+};
+
+static const u16 ANAGRAMS_POINTS[ANAGRAMS_MAX_LETTERS + 1] PROGMEM = { 0, 0, 0, 100, 400, 1200, 2000 };
+static const u16 WORDHUNT_POINTS[WORDHUNT_MAX_LETTERS + 1] PROGMEM = { 0, 0, 0, 100, 400, 800, 1400, 1800, 2200, 2600, 3000, 3400, 3800, 4200, 4600, 5000, 5400 };
+
+struct GameSchedule // Keeps what's given to the mouse within what's left of the game's clock.
+{
+	bool8 wordhunt;
+	u32   deadline_ms;
+	u32   finish_ms;        // When the mouse should be done with every word it's been given so far.
+	u32   predicted_points;
+};
+
+struct AnagramsRack // The tiles of the rack grouped by letter so that a word can be matched in one pass.
+{
+	u8 letter_counts['z' - 'a' + 1];
+	u8 first_slots  ['z' - 'a' + 1];  // Where the letter's tiles start in `slot_tiles`.
+	u8 slot_tiles   [ANAGRAMS_MAX_LETTERS];
+};
+
+// Bit `(a << 5) | b` is set when the 5-bit letter code `b` can come right after `a` in the current rack or grid.
+// Checking the links between letters is stronger than checking the letters alone (e.g. WordHunt letters must neighbor each other), and it can be done straight on a compressed tail.
+#define LETTER_PAIR_PADDING 31 // Slots past the end of a compressed tail are made this, which pairs with anything.
+static u8 letter_pairs[(1 << 10) / 8];
+#define letter_pair_fits(A, B) ((letter_pairs[((A) << 5 | (B)) >> 3] >> (((A) << 5 | (B)) & 7)) & 1)
+
+// "BANK.BIN" is a header followed by the words grouped into buckets by length and initial.
+// Buckets are sorted by descending length and then by initial. Each word is its signature and then its compressed tail.
+// Within a bucket, the words are grouped by their second letter into sub-buckets but otherwise stay in "WORDS.TXT" order.
+#define BANK_BIN_MAGIC                             0x4B4E4142UL // "BANK" when read as bytes.
+#define BANK_BIN_VERSION                           3            // Bump whenever the layout changes so that old files get remade.
+#define BANK_BUCKET_COUNT                          ((ABSOLUTE_MAX_LETTERS - MIN_LETTERS + 1) * ('z' - 'a' + 1))
+#define BANK_BUCKET_INDEX(WORD_LENGTH, WORD_INITIAL) ((ABSOLUTE_MAX_LETTERS - (WORD_LENGTH)) * ('z' - 'a' + 1) + (WORD_INITIAL) - 'a')
+struct BankHeader // Too big to keep in RAM; only used for the layout.
+{
+	u32 magic;
+	u16 version;
+	u16 initial_counts[BANK_BUCKET_COUNT];
+	u32 bucket_offsets[BANK_BUCKET_COUNT + 1]; // Where each bucket begins in the file. The extra entry is the size of the file, so a bucket's size is the difference with the next offset.
+	u16 sub_bucket_starts[BANK_BUCKET_COUNT]['z' - 'a' + 1]; // Index within the bucket of the first word with each second letter.
+};
+
+struct BankBucket
+{
+	u32 offset;
+	u16 count;
+};
+
+// "TRIE.BIN" is an optional copy of the dictionary as a trie so that a search can give up on a prefix once rather than on every word that has it.
+// It's made along with "BANK.BIN", but only if "WORDS.TXT" is sorted.
+// After the magic and version are the nodes in post-order. So each node comes right after its children's subtrees, and the root is at the very end.
+// A node's children are found by going backwards from the node: the last child's node comes right before, and its subtree
+// size leads to the end of the previous child's subtree, and so on.
+// This is what front-coding the sorted buckets of "BANK.BIN" would amount to: each shared prefix is stored once, and a subtree size is the skip
+// over every word that has the prefix. "BANK.BIN" itself keeps fixed-size records in "WORDS.TXT" order, since both "TRIE.BIN" and "RACKS.BIN"
+// refer to words by their index in a bucket and the slower scan is only ever used when "WORDS.TXT" isn't sorted anyway.
+#define TRIE_BIN_MAGIC     0x45495254UL // "TRIE" when read as bytes.
+#define TRIE_BIN_VERSION   2
+#define TRIE_NODE_TERMINAL (1UL << 31)  // Set in `TrieNode.mask` for when the letters leading up to the node make a word.
+struct TrieNode
+{
+	u32 mask;         // Bit for each letter that has a child.
+	u16 bank_index;   // Where the word is in its bucket of "BANK.BIN" for when the node is terminal.
+	u16 lengths;      // Bit `n - 1` is set when a word of `n` letters ends somewhere in the subtree, so walks can skip subtrees without the length they're after.
+	u32 subtree_size; // Bytes that the node and all of its descendants take up.
+};
+
+struct TrieWalk // Goes through the words of a particular length and initial in a trie that can be made out of either a rack of letters (Anagrams) or paths on a grid (WordHunt).
+{
+	FIL*  file;
+	bool8 on_grid;                               // Otherwise it's a rack.
+	u8    word_length;
+	u8    depth;                                 // Letters in `word` so far.
+	u8    word      [ABSOLUTE_MAX_LETTERS];
+	u8    cells     [ABSOLUTE_MAX_LETTERS];      // Where each letter of `word` is on the grid as `y * WORDHUNT_DIMS + x`.
+	u16   visited_cells;
+	u8    letter_counts['z' - 'a' + 1];          // What's left of the rack.
+	u32   letter_mask;                           // Letters of the rack that still have a nonzero count (or all letters of the grid).
+	struct
+	{
+		u32 remaining_mask;                     // Children that haven't been gone through yet.
+		u32 cursor;                             // Where the next child's subtree ends.
+		u32 child_offset;                       // The rest is about the child currently being stepped into.
+		u32 child_mask;
+		u16 child_bank_index;
+		u16 branches;                           // Ways left to step into the child: just one for a rack, otherwise a bit for each cell it can be on.
+		u8  child_letter;
+	} frames[ABSOLUTE_MAX_LETTERS];             // The node of `word` with `i` letters is at `i`.
+};
+
+// "RACKS.BIN" is optional and made by "misc/make_racks.c" from the same "WORDS.TXT" as "BANK.BIN".
+// It's the magic and version, then the offset of the answers of each sorted Anagrams rack by its rank (plus the size of the file at the end).
+// An answer is the word's length, its index in its bucket of "BANK.BIN", and then which tiles of the sorted rack spell it out.
+#define RACKS_BIN_MAGIC            0x4B434152UL // "RACK" when read as bytes.
+#define RACKS_BIN_VERSION          2
+#define RACKS_BIN_OFFSETS_POSITION (sizeof(u32) + sizeof(u16))
+
+// "FLASH.BIN" is made by "misc/make_flash_bank.c" and built into flash by "ATmega2560_flash_bank.S" when `FLASH_BANK` is `1`.
+// It's the magic and version, a bitmask of the lengths it has, and then the bucket offsets and words laid out like "BANK.BIN".
+// A length is either entirely in it or not at all, so a word's index in its bucket is the same as in "BANK.BIN".
+#ifndef FLASH_BANK
+#define FLASH_BANK 0
+#endif
+#define FLASH_BANK_MAGIC            0x48534C46UL // "FLSH" when read as bytes.
+#define FLASH_BANK_VERSION          1
+#define FLASH_BANK_OFFSETS_POSITION (sizeof(u32) + sizeof(u16) + sizeof(u32))
+#if FLASH_BANK
+extern const u8 flash_bank[];
+#endif
+static u32 flash_bank_length_mask; // Bit for each length that can be searched for without the SD card.
 
 #define WordEntryCallback(NAME) bool8 NAME(u8* letter_bank, u8* word, u8 word_length)
 typedef WordEntryCallback(WordEntryCallback);
 
 #define COMPRESSED_WORD_TAIL_LENGTH_FROM_WORD_LENGTH(WORD_LENGTH) ((((WORD_LENGTH) - 1) * 5 + ((WORD_LENGTH - 1) + 2) / 3 + 7) / 8)
+#define BANK_RECORD_SIZE(WORD_LENGTH) (sizeof(u32) + COMPRESSED_WORD_TAIL_LENGTH_FROM_WORD_LENGTH(WORD_LENGTH))
+
+// A signature is a bitmask of the letters used plus how many letters are repeats of an earlier one.
+// Any word that can be made out of some letters must have a subset of their bitmask and no more repeats.
+#define WORD_SIGNATURE_LETTERS       ((1UL << 26) - 1)
+#define WORD_SIGNATURE_REPEATS_SHIFT 26
+#define word_signature_fits(WORD_SIGNATURE, LETTERS_SIGNATURE) \
+	(!((WORD_SIGNATURE) & ~(LETTERS_SIGNATURE) & WORD_SIGNATURE_LETTERS) && ((WORD_SIGNATURE) >> WORD_SIGNATURE_REPEATS_SHIFT) <= ((LETTERS_SIGNATURE) >> WORD_SIGNATURE_REPEATS_SHIFT))
+
 union CompressedWordTailBuffer
 {
 	u8  elems_u8 [ COMPRESSED_WORD_TAIL_LENGTH_FROM_WORD_LENGTH(ABSOLUTE_MAX_LETTERS)         ];
@@ -82,10 +267,28 @@ enum MenuOption
 	MenuOption_COUNT
 };
 
-static u8
-decompress_word(u8* dst_word_buffer, u8 word_length, union CompressedWordTailBuffer* compressed_word_tail_buffer)
+static u32
+get_word_signature(const u8* letters, u8 letter_count)
 {
-	if (compressed_word_tail_buffer->elems_u8[0] == 0xFF)
+	u32 signature = 0;
+	for (u8 i = 0; i < letter_count; i += 1)
+	{
+		if (signature & (1UL << (letters[i] - 'a')))
+		{
+			signature += 1UL << WORD_SIGNATURE_REPEATS_SHIFT;
+		}
+		else
+		{
+			signature |= 1UL << (letters[i] - 'a');
+		}
+	}
+	return signature;
+}
+
+static u8 // `compressed_word_tail` is read as little-endian `u16`s, so it can point anywhere (e.g. straight into a `SDWindow`) as long as the byte after the tail is readable.
+decompress_word(u8* dst_word_buffer, u8 word_length, const u8* compressed_word_tail)
+{
+	if (compressed_word_tail[0] == 0xFF)
 	{
 		return false;
 	}
@@ -98,12 +301,15 @@ decompress_word(u8* dst_word_buffer, u8 word_length, union CompressedWordTailBuf
 		{
 			#pragma GCC diagnostic push
 			#pragma GCC diagnostic ignored "-Wimplicit-fallthrough"
-			#define CASE(WORD_LENGTH) case (WORD_LENGTH): dst_word_buffer[(WORD_LENGTH) - 1] = 'a' + ((compressed_word_tail_buffer->elems_u16[((WORD_LENGTH) - 2) / 3] >> ((((WORD_LENGTH) - 2) % 3) * 5)) & ((1 << 5) - 1));
+			#define ELEM_U16(INDEX)   ((u16) compressed_word_tail[(INDEX) * 2] | ((u16) compressed_word_tail[(INDEX) * 2 + 1] << 8))
+			#define CASE(WORD_LENGTH) case (WORD_LENGTH): dst_word_buffer[(WORD_LENGTH) - 1] = 'a' + ((ELEM_U16(((WORD_LENGTH) - 2) / 3) >> ((((WORD_LENGTH) - 2) % 3) * 5)) & ((1 << 5) - 1));
 			CASE(16); CASE(15); CASE(14);
 			CASE(13); CASE(12); CASE(11);
 			CASE(10); CASE( 9); CASE( 8);
 			CASE( 7); CASE( 6); CASE( 5);
 			CASE( 4); CASE( 3); CASE( 2);
+			#undef CASE
+			#undef ELEM_U16
 			#pragma GCC diagnostic pop
 		}
 
@@ -256,8 +462,438 @@ query_letters_nonliteral(struct LCD* lcd, const char* title, u8* dst_letters, u8
 	return mask;
 }
 
+#define BANK_BIN_MID_BATCH_SIZE  192 // Bytes of words gathered before they're written to "MID.BIN".
+#define BANK_BIN_LINK_MAP_LENGTH 64  // Enough for "BANK.BIN" to be split across 31 fragments of the SD card. Each fragment needs two entries and the terminator needs one.
+static DWORD bank_bin_link_map[BANK_BIN_LINK_MAP_LENGTH];
+
+union BankBinScratch // The counts are turned into offsets in place once they're written out, so only one of them takes up RAM.
+{
+	struct
+	{
+		u16 initial_counts[BANK_BUCKET_COUNT];
+		u8  words_chunk   [SD_SECTOR_SIZE];  // These are only needed while reading "WORDS.TXT", so they fit in what the offsets take up later.
+		u8  mid_batch     [BANK_BIN_MID_BATCH_SIZE];
+	};
+	u32 bucket_offsets[BANK_BUCKET_COUNT + 1];
+	struct
+	{
+		u32 bucket_starts     ['z' - 'a' + 1];
+		u16 sub_bucket_cursors['z' - 'a' + 1]['z' - 'a' + 1]; // Counts of the length's sub-buckets, then where the next word of each goes within its bucket.
+	};
+	struct
+	{
+		u16             bucket_indices[BANK_BUCKET_COUNT];
+		struct TrieNode open_nodes    [ABSOLUTE_MAX_LETTERS + 1]; // Nodes along the previous word that haven't been written yet. `subtree_size` is where the subtree began until then.
+		u8              previous_word [ABSOLUTE_MAX_LETTERS];
+	};
+};
+
+static union // Nothing in here is in use at the same time as anything else in here, so they share their RAM.
+{
+	struct
+	{
+		struct WordHuntBoard wordhunt_board; // Set up by `init_wordhunt_board` for whatever grid the user gave.
+		struct WordHuntPlan  wordhunt_plan;
+	};
+	struct AnagramsRack  anagrams_rack; // Set up by `init_anagrams_rack` for whatever rack the user gave.
+	union BankBinScratch bank_bin;      // Only while `init_bank_bin` is making "BANK.BIN", which is never in the middle of a game.
+} scratch;
+
+static const char* // `bank_file` is left at the beginning of the bucket.
+lookup_bank_bucket(struct BankBucket* dst_bucket, FIL* bank_file, u8 word_length, u8 word_initial)
+{
+	u32 bucket_bounds[2];
+	if
+	(
+		f_lseek(bank_file, offsetof(struct BankHeader, bucket_offsets) + BANK_BUCKET_INDEX(word_length, word_initial) * sizeof(u32)) ||
+		!sd_fread(bank_file, bucket_bounds, sizeof(bucket_bounds)) ||
+		f_lseek(bank_file, bucket_bounds[0])
+	)
+	{
+		PROC_ABORT("Failed to look up a bucket of \"BANK.BIN\".");
+	}
+
+	dst_bucket->offset = bucket_bounds[0];
+	dst_bucket->count  = (bucket_bounds[1] - bucket_bounds[0]) / BANK_RECORD_SIZE(word_length);
+	return 0;
+}
+
+static void
+init_flash_bank(void)
+{
+	#if FLASH_BANK
+	uint_farptr_t address = pgm_get_far_address(flash_bank);
+	if (pgm_read_dword_far(address) == FLASH_BANK_MAGIC && pgm_read_word_far(address + sizeof(u32)) == FLASH_BANK_VERSION)
+	{
+		flash_bank_length_mask = pgm_read_dword_far(address + sizeof(u32) + sizeof(u16));
+	}
+	else
+	{
+		uart_send_pstr("The \"FLASH.BIN\" that was built in is outdated and won't be used.\n");
+	}
+	#endif
+}
+
+static uint_farptr_t // Only for lengths in `flash_bank_length_mask`. Like `lookup_bank_bucket`, but the offset is where the bucket is in flash.
+lookup_flash_bucket(struct BankBucket* dst_bucket, u8 word_length, u8 word_initial)
+{
+	#if FLASH_BANK
+	uint_farptr_t address          = pgm_get_far_address(flash_bank);
+	uint_farptr_t offset_address   = address + FLASH_BANK_OFFSETS_POSITION + BANK_BUCKET_INDEX(word_length, word_initial) * sizeof(u32);
+	u32           bucket_bounds[2] = { pgm_read_dword_far(offset_address), pgm_read_dword_far(offset_address + sizeof(u32)) };
+	dst_bucket->offset = bucket_bounds[0];
+	dst_bucket->count  = (bucket_bounds[1] - bucket_bounds[0]) / BANK_RECORD_SIZE(word_length);
+	return address + bucket_bounds[0];
+	#else
+	dst_bucket->offset = 0;
+	dst_bucket->count  = 0;
+	return 0;
+	#endif
+}
+
+static const char* // The extra entry of `dst_starts` is the bucket's word count, so each sub-bucket ends where the next one starts.
+lookup_bank_sub_buckets(u16* dst_starts, FIL* bank_file, struct BankBucket* bucket, u8 word_length, u8 word_initial)
+{
+	if
+	(
+		f_lseek(bank_file, offsetof(struct BankHeader, sub_bucket_starts) + BANK_BUCKET_INDEX(word_length, word_initial) * ('z' - 'a' + 1) * sizeof(u16)) ||
+		!sd_fread(bank_file, dst_starts, ('z' - 'a' + 1) * sizeof(u16))
+	)
+	{
+		PROC_ABORT("Failed to look up the sub-buckets of \"BANK.BIN\".");
+	}
+
+	dst_starts['z' - 'a' + 1] = bucket->count;
+	return 0;
+}
+
+static u32 // Ranks the multisets of `ANAGRAMS_MAX_LETTERS` letters from `0` to `C(26 + ANAGRAMS_MAX_LETTERS - 1, ANAGRAMS_MAX_LETTERS) - 1`.
+get_rack_rank(const u8* sorted_letters)
+{
+	u32 rank = 0;
+	for (u8 i = 0; i < ANAGRAMS_MAX_LETTERS; i += 1) // The letters are made strictly increasing by adding their index, and then it's the combinatorial number system.
+	{
+		u32 binomial = 1;
+		u8  n        = sorted_letters[i] - 'a' + i;
+		for (u8 j = 0; j < i + 1; j += 1)
+		{
+			binomial = binomial * (n - j) / (j + 1);
+		}
+		rank += binomial;
+	}
+	return rank;
+}
+
+static void
+add_letter_pair(u8 a, u8 b)
+{
+	letter_pairs[(a << 5 | b) >> 3] |= 1 << ((a << 5 | b) & 7);
+}
+
+static void // Gets rid of the pairs of the last rack or grid.
+reset_letter_pairs(void)
+{
+	memset(letter_pairs, 0, sizeof(letter_pairs));
+	for (u8 letter = 0; letter <= LETTER_PAIR_PADDING; letter += 1)
+	{
+		add_letter_pair(letter, LETTER_PAIR_PADDING);
+		add_letter_pair(LETTER_PAIR_PADDING, letter);
+	}
+}
+
+static bool8 // Whether every two consecutive letters of the word can be paired up, which is checked a `u16` (three letters) at a time without decompressing the tail.
+compressed_word_tail_fits(const u8* compressed_word_tail, u8 word_length, u8 word_initial)
+{
+	if (compressed_word_tail[0] == 0xFF) // Removed word.
+	{
+		return false;
+	}
+
+	u8 previous_letter = word_initial - 'a';
+	u8 group_count     = (word_length - 1 + 2) / 3;
+	for (u8 group_index = 0; group_index < group_count; group_index += 1)
+	{
+		u16 group = (u16) compressed_word_tail[group_index * 2] | ((u16) compressed_word_tail[group_index * 2 + 1] << 8);
+		if (group_index == group_count - 1)
+		{
+			group |= ~((1U << (((word_length - 1) - group_index * 3) * 5)) - 1); // Pads the unused slots of the last group.
+		}
+
+		u8 a = (group >>  0) & 31;
+		u8 b = (group >>  5) & 31;
+		u8 c = (group >> 10) & 31;
+		if (!(letter_pair_fits(previous_letter, a) && letter_pair_fits(a, b) && letter_pair_fits(b, c)))
+		{
+			return false;
+		}
+		previous_letter = c;
+	}
+
+	return true;
+}
+
+static u8 // Position of the lowest set bit; the mask must be nonzero.
+get_lowest_bit(u32 mask)
+{
+	u8 bit = 0;
+	while (!(mask & (1UL << bit)))
+	{
+		bit += 1;
+	}
+	return bit;
+}
+
+static u8 // Inverse of `DIRECTIONS_X` and `DIRECTIONS_Y`, which go row by row around the center.
+get_direction_index(u8 from_cell, u8 to_cell)
+{
+	i8 dx    = (i8) (to_cell % WORDHUNT_DIMS) - (i8) (from_cell % WORDHUNT_DIMS);
+	i8 dy    = (i8) (to_cell / WORDHUNT_DIMS) - (i8) (from_cell / WORDHUNT_DIMS);
+	u8 index = (dy + 1) * 3 + (dx + 1);
+	return index > 4 ? index - 1 : index;
+}
+
+static void
+init_wordhunt_board(const u8* grid)
+{
+	memset(&scratch.wordhunt_board, 0, sizeof(scratch.wordhunt_board));
+	for (u8 cell = 0; cell < WORDHUNT_MAX_LETTERS; cell += 1)
+	{
+		for (u8 direction_index = 0; direction_index < DIRECTIONS_COUNT; direction_index += 1)
+		{
+			i8 x = cell % WORDHUNT_DIMS + get_direction_dx(direction_index);
+			i8 y = cell / WORDHUNT_DIMS + get_direction_dy(direction_index);
+			if (0 <= x && x < WORDHUNT_DIMS && 0 <= y && y < WORDHUNT_DIMS)
+			{
+				scratch.wordhunt_board.neighbor_masks[cell] |= 1U << (y * WORDHUNT_DIMS + x);
+			}
+		}
+
+		scratch.wordhunt_board.cell_letters[cell]               = grid[cell] - 'a';
+		scratch.wordhunt_board.letter_cells[grid[cell] - 'a'] |= 1U << cell;
+	}
+
+	scratch.wordhunt_plan.size        = 0;
+	scratch.wordhunt_plan.word_count  = 0;
+	scratch.wordhunt_plan.cursor_cell = WORDHUNT_NO_CELL; // Wherever the cursor is, it's not known to be on the grid.
+
+	reset_letter_pairs();
+	for (u8 cell = 0; cell < WORDHUNT_MAX_LETTERS; cell += 1) // Consecutive letters of a word have to be on neighboring cells.
+	{
+		for (u8 neighbor = 0; neighbor < WORDHUNT_MAX_LETTERS; neighbor += 1)
+		{
+			if (scratch.wordhunt_board.neighbor_masks[cell] & (1U << neighbor))
+			{
+				add_letter_pair(grid[cell] - 'a', grid[neighbor] - 'a');
+			}
+		}
+	}
+}
+
+static void
+init_anagrams_rack(const u8* rack)
+{
+	memset(&scratch.anagrams_rack, 0, sizeof(scratch.anagrams_rack));
+	for (u8 tile = 0; tile < ANAGRAMS_MAX_LETTERS; tile += 1)
+	{
+		scratch.anagrams_rack.letter_counts[rack[tile] - 'a'] += 1;
+	}
+
+	u8 slot = 0;
+	for (u8 letter = 0; letter < countof(scratch.anagrams_rack.first_slots); letter += 1)
+	{
+		scratch.anagrams_rack.first_slots[letter]  = slot;
+		slot                              += scratch.anagrams_rack.letter_counts[letter];
+	}
+
+	u8 filled_counts['z' - 'a' + 1] = {0};
+	for (u8 tile = 0; tile < ANAGRAMS_MAX_LETTERS; tile += 1) // Tiles of the same letter stay in rack order.
+	{
+		u8 letter = rack[tile] - 'a';
+		scratch.anagrams_rack.slot_tiles[scratch.anagrams_rack.first_slots[letter] + filled_counts[letter]]  = tile;
+		filled_counts[letter]                                                              += 1;
+	}
+
+	reset_letter_pairs();
+	for (u8 i = 0; i < ANAGRAMS_MAX_LETTERS; i += 1) // Two different tiles are needed for each pair, so a double letter needs the letter twice.
+	{
+		for (u8 j = 0; j < ANAGRAMS_MAX_LETTERS; j += 1)
+		{
+			if (i != j)
+			{
+				add_letter_pair(rack[i] - 'a', rack[j] - 'a');
+			}
+		}
+	}
+}
+
+static bool8
+read_trie_node(struct TrieNode* dst_node, FIL* trie_file, u32 node_offset)
+{
+	return f_lseek(trie_file, node_offset) == FR_OK && sd_fread(trie_file, dst_node, sizeof(*dst_node));
+}
+
+static u32 // Gets the letters that the next step of the walk can use. When `letter` is given, it's the cells the step can go to for that letter instead (or just `1` for a rack).
+_get_trie_walk_options(struct TrieWalk* walk, i8 letter)
+{
+	if (!walk->on_grid)
+	{
+		return letter < 0 ? walk->letter_mask : (walk->letter_mask >> letter) & 1;
+	}
+	else if (!walk->depth)
+	{
+		return letter < 0 ? walk->letter_mask : scratch.wordhunt_board.letter_cells[letter];
+	}
+	else
+	{
+		u16 cells = scratch.wordhunt_board.neighbor_masks[walk->cells[walk->depth - 1]] & ~walk->visited_cells;
+		if (letter >= 0)
+		{
+			return cells & scratch.wordhunt_board.letter_cells[letter];
+		}
+
+		u32 options = 0;
+		while (cells)
+		{
+			options |= 1UL << scratch.wordhunt_board.cell_letters[get_lowest_bit(cells)];
+			cells   &= cells - 1;
+		}
+		return options;
+	}
+}
+
+static void
+_step_trie_walk_back(struct TrieWalk* walk)
+{
+	walk->depth -= 1;
+	if (walk->on_grid)
+	{
+		walk->visited_cells &= ~(1U << walk->cells[walk->depth]);
+	}
+	else
+	{
+		walk->letter_counts[walk->word[walk->depth] - 'a'] += 1;
+		walk->letter_mask                                  |= 1UL << (walk->word[walk->depth] - 'a');
+	}
+}
+
+static const char* // With `on_grid`, `letter_bank` is the WordHunt grid that `init_wordhunt_board` was done on, otherwise it's a rack where each letter can be used as many times as it appears.
+open_trie_walk(struct TrieWalk* dst_walk, FIL* trie_file, u8 word_length, u8 word_initial, u8* letter_bank, u8 letter_bank_size, bool8 on_grid)
+{
+	dst_walk->file          = trie_file;
+	dst_walk->on_grid       = on_grid;
+	dst_walk->word_length   = word_length;
+	dst_walk->depth         = 0;
+	dst_walk->visited_cells = 0;
+	dst_walk->letter_mask   = 0;
+	memset(dst_walk->letter_counts, 0, sizeof(dst_walk->letter_counts));
+	for (u8 i = 0; i < letter_bank_size; i += 1)
+	{
+		dst_walk->letter_counts[letter_bank[i] - 'a'] += 1;
+		dst_walk->letter_mask                         |= 1UL << (letter_bank[i] - 'a');
+	}
+
+	struct TrieNode root;
+	u32             root_offset = f_size(trie_file) - sizeof(struct TrieNode);
+	if (!read_trie_node(&root, trie_file, root_offset))
+	{
+		PROC_ABORT("Failed to read the root of \"TRIE.BIN\".");
+	}
+
+	dst_walk->frames[0].remaining_mask = root.mask & (1UL << (word_initial - 'a')); // The walk is already done if there are no words with the initial.
+	dst_walk->frames[0].cursor         = root_offset;
+	dst_walk->frames[0].branches       = 0;
+	return 0;
+}
+
+static const char* // `*dst_found` is whether or not another word was put into `walk->word`; if not, then the walk is over.
+next_trie_word(struct TrieWalk* walk, u16* dst_bank_index, bool8* dst_found)
+{
+	*dst_found = false;
+
+	if (walk->depth == walk->word_length) // Going on from the word that was last found.
+	{
+		_step_trie_walk_back(walk);
+	}
+
+	while (true)
+	{
+		if (walk->frames[walk->depth].branches) // Take step forward.
+		{
+			u8 branch = get_lowest_bit(walk->frames[walk->depth].branches);
+			walk->frames[walk->depth].branches &= ~(1U << branch);
+
+			if (walk->on_grid)
+			{
+				walk->cells[walk->depth]  = branch;
+				walk->visited_cells      |= 1U << branch;
+			}
+			else
+			{
+				walk->letter_counts[walk->frames[walk->depth].child_letter] -= 1;
+				if (!walk->letter_counts[walk->frames[walk->depth].child_letter])
+				{
+					walk->letter_mask &= ~(1UL << walk->frames[walk->depth].child_letter);
+				}
+			}
+			walk->word[walk->depth]  = 'a' + walk->frames[walk->depth].child_letter;
+			walk->depth             += 1;
+
+			if (walk->depth == walk->word_length)
+			{
+				if (walk->frames[walk->depth - 1].child_mask & TRIE_NODE_TERMINAL)
+				{
+					*dst_bank_index = walk->frames[walk->depth - 1].child_bank_index;
+					*dst_found      = true;
+					return 0;
+				}
+				_step_trie_walk_back(walk);
+			}
+			else
+			{
+				walk->frames[walk->depth].remaining_mask = walk->frames[walk->depth - 1].child_mask & ~TRIE_NODE_TERMINAL;
+				walk->frames[walk->depth].cursor         = walk->frames[walk->depth - 1].child_offset;
+				walk->frames[walk->depth].branches       = 0;
+			}
+		}
+		else if (walk->frames[walk->depth].remaining_mask & _get_trie_walk_options(walk, -1)) // Find the next child that has a chance.
+		{
+			u8 letter = 'z' - 'a';
+			while (!(walk->frames[walk->depth].remaining_mask & (1UL << letter)))
+			{
+				letter -= 1;
+			}
+			walk->frames[walk->depth].remaining_mask &= ~(1UL << letter);
+
+			u32             child_offset = walk->frames[walk->depth].cursor - sizeof(struct TrieNode);
+			struct TrieNode child;
+			if (!read_trie_node(&child, walk->file, child_offset))
+			{
+				PROC_ABORT("Failed to read a node of \"TRIE.BIN\".");
+			}
+			walk->frames[walk->depth].cursor -= child.subtree_size;
+
+			if (child.lengths & (1U << (walk->word_length - 1)))
+			{
+				walk->frames[walk->depth].child_offset     = child_offset;
+				walk->frames[walk->depth].child_mask       = child.mask;
+				walk->frames[walk->depth].child_bank_index = child.bank_index;
+				walk->frames[walk->depth].child_letter     = letter;
+				walk->frames[walk->depth].branches         = _get_trie_walk_options(walk, letter);
+			}
+		}
+		else if (walk->depth) // Backtrack.
+		{
+			_step_trie_walk_back(walk);
+		}
+		else
+		{
+			return 0;
+		}
+	}
+}
+
 static const char*
-init_bank_bin(FIL* bank_file, InitialCounts dst_initial_counts, struct LCD* lcd, bool8 must_remake)
+init_bank_bin(FIL* bank_file, struct LCD* lcd, bool8 must_remake)
 {
 	if (!must_remake)
 	{
@@ -270,17 +906,28 @@ init_bank_bin(FIL* bank_file, InitialCounts dst_initial_counts, struct LCD* lcd,
 
 			case FR_OK:
 			{
+				u32 magic;
+				u16 version;
 				if (f_open(bank_file, "BANK.BIN", FA_READ | FA_WRITE | FA_OPEN_EXISTING))
 				{
 					PROC_ABORT("\"BANK.BIN\" failed to open.");
 				}
-				else if (sd_fread(bank_file, dst_initial_counts, sizeof(InitialCounts)))
+				else if (!sd_fread(bank_file, &magic, sizeof(magic)) || !sd_fread(bank_file, &version, sizeof(version)))
+				{
+					PROC_ABORT("Failed to read \"BANK.BIN\".");
+				}
+				else if (magic == BANK_BIN_MAGIC && version == BANK_BIN_VERSION)
 				{
+					sd_enable_fast_seek(bank_file, bank_bin_link_map, countof(bank_bin_link_map)); // Seeking still works without it, just slower on a fragmented SD card.
 					return 0;
 				}
+				else if (f_close(bank_file))
+				{
+					PROC_ABORT("Failed to close \"BANK.BIN\".");
+				}
 				else
 				{
-					PROC_ABORT("Failed to read \"BANK.BIN\".");
+					uart_send_pstr("\"BANK.BIN\" is outdated and will be remade.\n");
 				}
 			} break;
 
@@ -293,7 +940,22 @@ init_bank_bin(FIL* bank_file, InitialCounts dst_initial_counts, struct LCD* lcd,
 
 	u32 starting_time_ms   = get_ms();
 	u8  lcd_buffering_tick = 0;
-	memset(dst_initial_counts, 0, sizeof(InitialCounts));
+
+	switch (f_unlink("TRIE.BIN")) // So an old trie never gets paired with a new "BANK.BIN".
+	{
+		case FR_OK:
+		case FR_NO_FILE:
+		{
+		} break;
+
+		default:
+		{
+			PROC_ABORT("Failed to remove \"TRIE.BIN\".");
+		} break;
+	}
+
+	union BankBinScratch* bank_table = &scratch.bank_bin;
+	memset(bank_table, 0, sizeof(*bank_table));
 
 	FIL mid_file;
 	if (f_open(&mid_file, "MID.BIN", FA_READ | FA_WRITE | FA_CREATE_ALWAYS))
@@ -308,56 +970,97 @@ init_bank_bin(FIL* bank_file, InitialCounts dst_initial_counts, struct LCD* lcd,
 			PROC_ABORT("Could not read \"WORDS.TXT\".");
 		}
 
-		while (!f_eof(&words_file))
-		{
-			//
-			// Get word.
-			//
-
-			struct
-			{
-				u8 length;
-				u8 buffer[ABSOLUTE_MAX_LETTERS];
-			} word;
-			word.length = 0;
+		//
+		// "WORDS.TXT" is read a sector at a time and words are scanned straight out of the chunk. A word is any run of
+		// letters (of either case) between whitespace, so CRLF line endings are fine, and anything containing other
+		// characters (e.g. "don't") is skipped entirely.
+		//
 
-			while (true)
+		struct
+		{
+			u8 length;
+			u8 buffer[ABSOLUTE_MAX_LETTERS];
+		} word;
+		word.length = 0;
+
+		bool8 word_valid      = true;
+		u16   chunk_cursor    = 0;
+		u16   chunk_end       = 0;
+		u8    mid_batch_size  = 0;
+		bool8 reached_the_end = false;
+		while (!reached_the_end)
+		{
+			u8 character = '\n'; // Whitespace at the very end to commit the last word.
+			if (chunk_cursor == chunk_end)
 			{
 				u16 read_amount;
-				u8  word_letter;
-				if (f_read(&words_file, &word_letter, sizeof(word_letter), &read_amount))
+				if (f_read(&words_file, bank_table->words_chunk, sizeof(bank_table->words_chunk), &read_amount))
 				{
 					PROC_ABORT("Failed to read from \"WORDS.TXT\".");
 				}
-				if (read_amount == 1 && 'a' <= word_letter && word_letter <= 'z')
+				chunk_cursor    = 0;
+				chunk_end       = read_amount;
+				reached_the_end = !read_amount;
+				set_lcd_to_show_creation_of_bank_file(lcd, false, &lcd_buffering_tick);
+			}
+			if (chunk_cursor < chunk_end)
+			{
+				character     = bank_table->words_chunk[chunk_cursor];
+				chunk_cursor += 1;
+			}
+
+			if ('A' <= character && character <= 'Z')
+			{
+				character += 'a' - 'A';
+			}
+
+			if ('a' <= character && character <= 'z')
+			{
+				if (word.length < countof(word.buffer))
 				{
-					if (word.length < countof(word.buffer))
-					{
-						word.buffer[word.length] = word_letter;
-					}
-					word.length += 1;
+					word.buffer[word.length] = character;
 				}
-				else
+				if (word.length < 0xFF)
 				{
-					break;
+					word.length += 1;
 				}
 			}
-
-			//
-			// Commit word to "MID.BIN" if it's of legal length and update count.
-			//
-
-			if (MIN_LETTERS <= word.length && word.length <= ABSOLUTE_MAX_LETTERS)
+			else if (character <= ' ')
 			{
-				if (!sd_fwrite(&mid_file, &word, 1 + word.length))
+				//
+				// Commit word to the batch for "MID.BIN" if it's of legal length and update count.
+				//
+
+				if (word_valid && MIN_LETTERS <= word.length && word.length <= ABSOLUTE_MAX_LETTERS)
 				{
-					PROC_ABORT("Failed to write to \"MID.BIN\".");
+					if (mid_batch_size + 1 + word.length > BANK_BIN_MID_BATCH_SIZE)
+					{
+						if (!sd_fwrite(&mid_file, bank_table->mid_batch, mid_batch_size))
+						{
+							PROC_ABORT("Failed to write to \"MID.BIN\".");
+						}
+						mid_batch_size = 0;
+					}
+					memcpy(bank_table->mid_batch + mid_batch_size, &word, 1 + word.length);
+					mid_batch_size += 1 + word.length;
+
+					bank_table->initial_counts[BANK_BUCKET_INDEX(word.length, word.buffer[0])] += 1;
 				}
-				dst_initial_counts[ABSOLUTE_MAX_LETTERS - word.length][word.buffer[0] - 'a'] += 1;
-				set_lcd_to_show_creation_of_bank_file(lcd, false, &lcd_buffering_tick);
+
+				word.length = 0;
+				word_valid  = true;
+			}
+			else
+			{
+				word_valid = false;
 			}
 		}
 
+		if (!sd_fwrite(&mid_file, bank_table->mid_batch, mid_batch_size))
+		{
+			PROC_ABORT("Failed to write to \"MID.BIN\".");
+		}
+
 		if (f_close(&words_file))
 		{
 			PROC_ABORT("Failed to close \"WORDS.TXT\".");
@@ -365,219 +1068,610 @@ init_bank_bin(FIL* bank_file, InitialCounts dst_initial_counts, struct LCD* lcd,
 	}
 
 
-	if (f_lseek(&mid_file, 0))
-	{
-		PROC_ABORT("Failed to seek \"MID.BIN\".");
-	}
-
 	{ // Sort "MID.BIN" into "BANK.BIN".
-		FIL bank_file;
-		if (f_open(&bank_file, "BANK.BIN", FA_WRITE | FA_CREATE_ALWAYS))
+		if (f_open(bank_file, "BANK.BIN", FA_READ | FA_WRITE | FA_CREATE_ALWAYS))
 		{
-			return PSTR("Could not read \"BANK.BIN\".\n");
+			PROC_ABORT("Could not create \"BANK.BIN\".");
 		}
 
-		if (!sd_fwrite(&bank_file, dst_initial_counts, sizeof(InitialCounts)))
+		u32 bank_size    = sizeof(struct BankHeader);
+		u32 length_mask  = 0; // Bit for each length that has words, since the counts won't be around for the passes.
+		for (u8 word_length = ABSOLUTE_MAX_LETTERS; word_length >= MIN_LETTERS; word_length -= 1)
 		{
-			return PSTR("Failed to write to \"BANK.BIN\".\n");
+			for (u8 word_initial = 'a'; word_initial <= 'z'; word_initial += 1)
+			{
+				bank_size += (u32) bank_table->initial_counts[BANK_BUCKET_INDEX(word_length, word_initial)] * BANK_RECORD_SIZE(word_length);
+				if (bank_table->initial_counts[BANK_BUCKET_INDEX(word_length, word_initial)])
+				{
+					length_mask |= 1UL << word_length;
+				}
+			}
 		}
 
-		InitialCounts written_initial_counts = {0};
-		while (!f_eof(&mid_file))
+		if
+		(
+			!sd_fwrite(bank_file, &(u32) { BANK_BIN_MAGIC   }, sizeof(u32)) ||
+			!sd_fwrite(bank_file, &(u16) { BANK_BIN_VERSION }, sizeof(u16)) ||
+			!sd_fwrite(bank_file, bank_table->initial_counts, sizeof(bank_table->initial_counts))
+		)
 		{
-			//
-			// Get word from "MID.BIN".
-			//
+			PROC_ABORT("Failed to write to \"BANK.BIN\".");
+		}
 
-			u8 word_length;
-			u8 word_buffer[ABSOLUTE_MAX_LETTERS];
-			if (!sd_fread(&mid_file, &word_length, sizeof(word_length)) || !sd_fread(&mid_file, &word_buffer, word_length))
+		{ // Going backwards from the end of the file means each count is read before its slot is overwritten by the wider offset.
+			u32 bucket_offset = bank_size;
+			bank_table->bucket_offsets[BANK_BUCKET_COUNT] = bucket_offset;
+			for (u8 word_length = MIN_LETTERS; word_length <= ABSOLUTE_MAX_LETTERS; word_length += 1)
 			{
-				PROC_ABORT("Failed to read from \"MID.BIN\".");
+				for (u8 word_initial = 'z'; word_initial >= 'a'; word_initial -= 1)
+				{
+					bucket_offset -= (u32) bank_table->initial_counts[BANK_BUCKET_INDEX(word_length, word_initial)] * BANK_RECORD_SIZE(word_length);
+					bank_table->bucket_offsets[BANK_BUCKET_INDEX(word_length, word_initial)] = bucket_offset;
+				}
 			}
+		}
 
-			//
-			// Seek "BANK.BIN".
-			//
+		if (!sd_fwrite(bank_file, bank_table->bucket_offsets, sizeof(bank_table->bucket_offsets)))
+		{
+			PROC_ABORT("Failed to write to \"BANK.BIN\".");
+		}
 
+		//
+		// "BANK.BIN" is written front to back by going through "MID.BIN" once for each length. Since "WORDS.TXT" is
+		// alphabetical, the words of a length come out in the same order as their sub-buckets, so the tails can just be
+		// appended while the sub-buckets are counted. FatFs holds them in the file's sector buffer and only writes out whole
+		// sectors, which the SD driver then streams as a single multi-block write. When a word comes out of order, the rest
+		// of the length is only counted, and a second pass then writes each word where the counts say it goes, costing a
+		// seek for each one.
+		//
+		// The sub-bucket starts of every length are too big to keep in RAM, so they're tacked onto the end of "MID.BIN" as
+		// each length is done, and then copied into the header that was left for them with just one seek into "BANK.BIN".
+		//
+
+		u32 mid_size      = f_size(&mid_file);
+		u32 length_offset = sizeof(struct BankHeader); // Where the buckets of the length begin.
+		for (u8 pass_word_length = ABSOLUTE_MAX_LETTERS; pass_word_length >= MIN_LETTERS; pass_word_length -= 1)
+		{
+			memset(bank_table->sub_bucket_cursors, 0, sizeof(bank_table->sub_bucket_cursors));
+
+			if (length_offset != f_tell(bank_file) && f_lseek(bank_file, length_offset)) // Skips over the header on the first length, or wherever the second pass of the previous length left off.
 			{
-				u32 seek_offset = sizeof(InitialCounts);
-				for (u8 seek_word_length = ABSOLUTE_MAX_LETTERS; seek_word_length > word_length; seek_word_length -= 1)
+				PROC_ABORT("Failed to seek \"BANK.BIN\".");
+			}
+
+			u8 pass_count = 1; // Becomes `2` once a word comes out of order.
+			for (u8 pass_index = 0; pass_index < pass_count; pass_index += 1) // The first pass counts the sub-buckets and appends the words while it can, and the second writes the words into them.
+			{
+				u16 previous_sub_bucket_index = 0;
+
+				if (!(length_mask & (1UL << pass_word_length)))
+				{
+					// No words of this length, but the sub-buckets still need to be written out as empty.
+				}
+				else if (f_lseek(&mid_file, 0))
+				{
+					PROC_ABORT("Failed to seek \"MID.BIN\".");
+				}
+				else
 				{
-					for (u8 seek_iniital = 'a'; seek_iniital <= 'z'; seek_iniital += 1)
+					while (f_tell(&mid_file) < mid_size)
 					{
-						seek_offset += dst_initial_counts[ABSOLUTE_MAX_LETTERS - seek_word_length][seek_iniital - 'a'] * COMPRESSED_WORD_TAIL_LENGTH_FROM_WORD_LENGTH(seek_word_length);
+						//
+						// Get word from "MID.BIN".
+						//
+
+						u8 word_length;
+						u8 word_buffer[ABSOLUTE_MAX_LETTERS];
+						if (!sd_fread(&mid_file, &word_length, sizeof(word_length)) || !sd_fread(&mid_file, &word_buffer, word_length))
+						{
+							PROC_ABORT("Failed to read from \"MID.BIN\".");
+						}
+						if (word_length != pass_word_length)
+						{
+							continue;
+						}
+
+						u16* sub_bucket_cursor = &bank_table->sub_bucket_cursors[word_buffer[0] - 'a'][word_buffer[1] - 'a'];
+						u32  record_offset     = f_tell(bank_file);
+						if (pass_index == 0)
+						{
+							u16 sub_bucket_index = (word_buffer[0] - 'a') * ('z' - 'a' + 1) + word_buffer[1] - 'a';
+							if (sub_bucket_index < previous_sub_bucket_index)
+							{
+								pass_count = 2;
+							}
+							previous_sub_bucket_index  = sub_bucket_index;
+							*sub_bucket_cursor        += 1;
+
+							if (pass_count == 2)
+							{
+								continue;
+							}
+						}
+						else
+						{
+							record_offset       = bank_table->bucket_starts[word_buffer[0] - 'a'] + (u32) *sub_bucket_cursor * BANK_RECORD_SIZE(word_length);
+							*sub_bucket_cursor += 1;
+						}
+
+						//
+						// Compress and write to the end of what's been written of the sub-bucket so far.
+						//
+
+						union CompressedWordTailBuffer compressed_word_tail_buffer = {0};
+						for (u8 i = 0; i < word_length - 1; i += 1)
+						{
+							compressed_word_tail_buffer.elems_u16[i / 3] |= (word_buffer[1 + i] - 'a') << ((i % 3) * 5);
+						}
+
+						if (record_offset != f_tell(bank_file) && f_lseek(bank_file, record_offset))
+						{
+							PROC_ABORT("Failed to seek \"BANK.BIN\".");
+						}
+						if
+						(
+							!sd_fwrite(bank_file, &(u32) { get_word_signature(word_buffer, word_length) }, sizeof(u32)) ||
+							!sd_fwrite(bank_file, &compressed_word_tail_buffer, COMPRESSED_WORD_TAIL_LENGTH_FROM_WORD_LENGTH(word_length))
+						)
+						{
+							PROC_ABORT("Failed to write \"BANK.BIN\".");
+						}
+
+						set_lcd_to_show_creation_of_bank_file(lcd, true, &lcd_buffering_tick);
 					}
 				}
-				for (u8 seek_iniital = 'a'; seek_iniital < word_buffer[0]; seek_iniital += 1)
+
+				if (pass_index == 0) // Turn the counts into where each sub-bucket starts and put them aside for the header.
+				{
+					for (u8 initial_index = 0; initial_index < countof(bank_table->bucket_starts); initial_index += 1)
+					{
+						u16 bucket_count = 0;
+						for (u8 second_index = 0; second_index < countof(bank_table->sub_bucket_cursors[initial_index]); second_index += 1)
+						{
+							u16 sub_bucket_count                                        = bank_table->sub_bucket_cursors[initial_index][second_index];
+							bank_table->sub_bucket_cursors[initial_index][second_index]  = bucket_count;
+							bucket_count                                               += sub_bucket_count;
+						}
+						bank_table->bucket_starts[initial_index]  = length_offset;
+						length_offset                           += (u32) bucket_count * BANK_RECORD_SIZE(pass_word_length);
+					}
+
+					if
+					(
+						f_lseek(&mid_file, f_size(&mid_file)) ||
+						!sd_fwrite(&mid_file, bank_table->sub_bucket_cursors, sizeof(bank_table->sub_bucket_cursors))
+					)
+					{
+						PROC_ABORT("Failed to write to \"MID.BIN\".");
+					}
+				}
+			}
+		}
+
+		if (f_lseek(bank_file, offsetof(struct BankHeader, sub_bucket_starts)) || f_lseek(&mid_file, mid_size))
+		{
+			PROC_ABORT("Failed to seek to the sub-bucket starts.");
+		}
+		for (u8 word_length = ABSOLUTE_MAX_LETTERS; word_length >= MIN_LETTERS; word_length -= 1)
+		{
+			if
+			(
+				!sd_fread(&mid_file, bank_table->sub_bucket_cursors, sizeof(bank_table->sub_bucket_cursors)) ||
+				!sd_fwrite(bank_file, bank_table->sub_bucket_cursors, sizeof(bank_table->sub_bucket_cursors))
+			)
+			{
+				PROC_ABORT("Failed to copy the sub-bucket starts into \"BANK.BIN\".");
+			}
+		}
+		if (f_lseek(&mid_file, mid_size) || f_truncate(&mid_file)) // So only the words are left for "TRIE.BIN".
+		{
+			PROC_ABORT("Failed to truncate \"MID.BIN\".");
+		}
+
+		if (f_sync(bank_file))
+		{
+			PROC_ABORT("Failed to flush \"BANK.BIN\".");
+		}
+		sd_enable_fast_seek(bank_file, bank_bin_link_map, countof(bank_bin_link_map)); // Only now that the file is its final size.
+	}
+
+	{ // Build "TRIE.BIN" out of "MID.BIN".
+		FIL trie_file;
+		if (f_open(&trie_file, "TRIE.BIN", FA_WRITE | FA_CREATE_ALWAYS))
+		{
+			PROC_ABORT("Could not create \"TRIE.BIN\".");
+		}
+		if (!sd_fwrite(&trie_file, &(u32) { TRIE_BIN_MAGIC }, sizeof(u32)) || !sd_fwrite(&trie_file, &(u16) { TRIE_BIN_VERSION }, sizeof(u16)))
+		{
+			PROC_ABORT("Failed to write to \"TRIE.BIN\".");
+		}
+		if (f_lseek(&mid_file, 0))
+		{
+			PROC_ABORT("Failed to seek \"MID.BIN\".");
+		}
+
+		memset(bank_table->bucket_indices, 0, sizeof(bank_table->bucket_indices));
+		bank_table->open_nodes[0] = (struct TrieNode) { .subtree_size = f_tell(&trie_file) };
+
+		u8    previous_word_length = 0;
+		bool8 sorted               = true;
+		while (true)
+		{
+			//
+			// Get word from "MID.BIN" and where it ended up in "BANK.BIN".
+			//
+
+			u8  word_length = 0; // Closes all of the remaining nodes at the end.
+			u8  word_buffer[ABSOLUTE_MAX_LETTERS];
+			u16 bank_index  = 0;
+			if (!f_eof(&mid_file))
+			{
+				if (!sd_fread(&mid_file, &word_length, sizeof(word_length)) || !sd_fread(&mid_file, &word_buffer, word_length))
 				{
-					seek_offset += dst_initial_counts[ABSOLUTE_MAX_LETTERS - word_length][seek_iniital - 'a'] * COMPRESSED_WORD_TAIL_LENGTH_FROM_WORD_LENGTH(word_length);
+					PROC_ABORT("Failed to read from \"MID.BIN\".");
 				}
-				seek_offset += written_initial_counts[ABSOLUTE_MAX_LETTERS - word_length][word_buffer[0] - 'a'] * COMPRESSED_WORD_TAIL_LENGTH_FROM_WORD_LENGTH(word_length);
+				bank_index                                                                  = bank_table->bucket_indices[BANK_BUCKET_INDEX(word_length, word_buffer[0])];
+				bank_table->bucket_indices[BANK_BUCKET_INDEX(word_length, word_buffer[0])] += 1;
+			}
+
+			u8 common_length = 0;
+			while (common_length < word_length && common_length < previous_word_length && word_buffer[common_length] == bank_table->previous_word[common_length])
+			{
+				common_length += 1;
+			}
 
-				if (f_lseek(&bank_file, seek_offset))
+			if (word_length && (common_length == word_length || (common_length < previous_word_length && word_buffer[common_length] < bank_table->previous_word[common_length])))
+			{
+				if (common_length == word_length && word_length == previous_word_length)
 				{
-					PROC_ABORT("Failed to seek \"BANK.BIN\".");
+					continue; // Duplicates just keep the first one.
 				}
+
+				sorted = false;
+				break;
 			}
 
 			//
-			// Compress, write, and increment.
+			// Write out the nodes that the word doesn't share with the previous one, since they can't get any more children.
 			//
 
-			union CompressedWordTailBuffer compressed_word_tail_buffer = {0};
-			for (u8 i = 0; i < word_length - 1; i += 1)
+			for (u8 depth = previous_word_length; depth > common_length || !word_length; depth -= 1) // The root goes last once there are no more words.
 			{
-				compressed_word_tail_buffer.elems_u16[i / 3] |= (word_buffer[1 + i] - 'a') << ((i % 3) * 5);
+				struct TrieNode* node = &bank_table->open_nodes[depth];
+				node->subtree_size = f_tell(&trie_file) + sizeof(struct TrieNode) - node->subtree_size;
+				if (!sd_fwrite(&trie_file, node, sizeof(struct TrieNode)))
+				{
+					PROC_ABORT("Failed to write to \"TRIE.BIN\".");
+				}
+
+				if (depth == 0)
+				{
+					break;
+				}
+				bank_table->open_nodes[depth - 1].mask    |= 1UL << (bank_table->previous_word[depth - 1] - 'a');
+				bank_table->open_nodes[depth - 1].lengths |= node->lengths;
+			}
+
+			if (!word_length)
+			{
+				break;
 			}
-			if (!sd_fwrite(&bank_file, &compressed_word_tail_buffer, COMPRESSED_WORD_TAIL_LENGTH_FROM_WORD_LENGTH(word_length)))
+
+			for (u8 depth = common_length + 1; depth <= word_length; depth += 1)
 			{
-				PROC_ABORT("Failed to write \"BANK.BIN\".");
+				bank_table->open_nodes[depth] = (struct TrieNode) { .subtree_size = f_tell(&trie_file) };
 			}
+			bank_table->open_nodes[word_length].mask       |= TRIE_NODE_TERMINAL;
+			bank_table->open_nodes[word_length].bank_index  = bank_index;
+			bank_table->open_nodes[word_length].lengths    |= 1U << (word_length - 1);
+
+			memcpy(bank_table->previous_word, word_buffer, word_length);
+			previous_word_length = word_length;
 
-			written_initial_counts[ABSOLUTE_MAX_LETTERS - word_length][word_buffer[0] - 'a'] += 1;
 			set_lcd_to_show_creation_of_bank_file(lcd, true, &lcd_buffering_tick);
 		}
+
+		if (f_close(&trie_file))
+		{
+			PROC_ABORT("Failed to close \"TRIE.BIN\".");
+		}
+		if (!sorted)
+		{
+			if (f_unlink("TRIE.BIN"))
+			{
+				PROC_ABORT("Failed to remove \"TRIE.BIN\".");
+			}
+			uart_send_pstr("\"WORDS.TXT\" isn't sorted, so the slower searches through \"BANK.BIN\" will be used instead of \"TRIE.BIN\".\n");
+		}
+	}
+
+	if (f_close(&mid_file))
+	{
+		PROC_ABORT("Failed to close \"MID.BIN\".");
+	}
+
+	if (f_unlink("MID.BIN"))
+	{
+		PROC_ABORT("Failed to remove \"MID.BIN\".");
+	}
+
+	uart_send_pstr("Making \"BANK.BIN\" took: ");
+	uart_send_u64(get_ms() - starting_time_ms);
+	uart_send_pstr("ms.\n");
+	sd_report_cache();
+	report_stack();
+
+	set_lcd_to_show_success(lcd, "\"BANK.BIN\" made");
+
+	return 0;
+}
+
+static
+WordEntryCallback(anagrams_callback) // Expects `init_anagrams_rack` to have been done on `letter_bank`.
+{
+	u8 taken_counts['z' - 'a' + 1]; // Only the entries of the word's letters are used, so only those get cleared.
+	for (u8 i = 0; i < word_length; i += 1)
+	{
+		taken_counts[word[i] - 'a'] = 0;
+	}
+
+	i8 index_buffer[ANAGRAMS_MAX_LETTERS];
+	for (u8 i = 0; i < word_length; i += 1) // Each letter of the word takes the next tile of that letter, if there's still one left.
+	{
+		u8 letter = word[i] - 'a';
+		if (taken_counts[letter] == scratch.anagrams_rack.letter_counts[letter])
+		{
+			return false;
+		}
+		index_buffer[i]       = scratch.anagrams_rack.slot_tiles[scratch.anagrams_rack.first_slots[letter] + taken_counts[letter]];
+		taken_counts[letter] += 1;
+	}
+
+	play_mouse_anagrams(index_buffer, word_length);
+
+	return true;
+}
+
+static void
+open_wordhunt_paths(struct WordHuntPaths* paths, u16 start_cells)
+{
+	paths->untried_cells[0] = start_cells;
+	paths->visited_cells    = 0;
+	paths->depth            = 0;
+}
+
+static bool8 // Puts the next path that spells out the word into `paths->cells`, if there's one left.
+next_wordhunt_path(struct WordHuntPaths* paths, const u8* word, u8 word_length)
+{
+	while (true)
+	{
+		if (paths->untried_cells[paths->depth]) // Take step forward.
+		{
+			paths->cells        [paths->depth]  = get_lowest_bit(paths->untried_cells[paths->depth]);
+			paths->untried_cells[paths->depth] &= paths->untried_cells[paths->depth] - 1;
+
+			if (paths->depth + 1 == word_length) // We got to the end.
+			{
+				return true;
+			}
+
+			paths->visited_cells               |= 1U << paths->cells[paths->depth];
+			paths->depth                       += 1;
+			paths->untried_cells[paths->depth]  = scratch.wordhunt_board.neighbor_masks[paths->cells[paths->depth - 1]] & scratch.wordhunt_board.letter_cells[word[paths->depth] - 'a'] & ~paths->visited_cells;
+		}
+		else if (paths->depth) // Backtrack and try the next cell.
+		{
+			paths->depth         -= 1;
+			paths->visited_cells &= ~(1U << paths->cells[paths->depth]);
+		}
+		else
+		{
+			return false;
+		}
 	}
+}
 
-	if (f_close(&mid_file))
+static u8 // Roughly twice the straight-line distance, since that's what the cursor has to travel.
+get_cell_distance(u8 from_cell, u8 to_cell)
+{
+	if (from_cell == WORDHUNT_NO_CELL || to_cell == WORDHUNT_NO_CELL)
 	{
-		PROC_ABORT("Failed to close \"MID.BIN\".");
+		return 0;
 	}
 
-	if (f_unlink("MID.BIN"))
+	i8 dx = (i8) (to_cell % WORDHUNT_DIMS) - (i8) (from_cell % WORDHUNT_DIMS);
+	i8 dy = (i8) (to_cell / WORDHUNT_DIMS) - (i8) (from_cell / WORDHUNT_DIMS);
+	dx = dx < 0 ? -dx : dx;
+	dy = dy < 0 ? -dy : dy;
+	return dx > dy ? 2 * dx + dy : 2 * dy + dx;
+}
+
+static void // Plays every planned word, nearest start first from wherever the last word ended.
+play_wordhunt_plan(void)
+{
+	u8 order[WORDHUNT_PLAN_MAX_WORDS]; // Planned words by when they'll be played.
+	u8 ends [WORDHUNT_PLAN_MAX_WORDS]; // The chosen end of each word of `order`.
+	for (u8 i = 0; i < scratch.wordhunt_plan.word_count; i += 1)
 	{
-		PROC_ABORT("Failed to remove \"MID.BIN\".");
+		order[i] = i;
 	}
 
-	uart_send_pstr("Making \"BANK.BIN\" took: ");
-	uart_send_u64(get_ms() - starting_time_ms);
-	uart_send_pstr("ms.\n");
-
-	set_lcd_to_show_success(lcd, "\"BANK.BIN\" made");
-
-	return 0;
-}
+	//
+	// Greedily pick the word that can be started the closest to where the cursor is.
+	//
 
-static
-WordEntryCallback(anagrams_callback)
-{
-	i8    index_buffer[ANAGRAMS_MAX_LETTERS];
-	bool8 valid = true;
-	for (u8 word_letter_index = 0; word_letter_index < word_length; word_letter_index += 1) // Iterate through each letter in the word to see if it's in the provided letter-bank.
+	u8 cursor_cell = scratch.wordhunt_plan.cursor_cell;
+	for (u8 i = 0; i < scratch.wordhunt_plan.word_count; i += 1)
 	{
-		for (u8 bank_letter_index = 0; bank_letter_index < ANAGRAMS_MAX_LETTERS; bank_letter_index += 1)
+		u8 best_cost  = 0xFF;
+		u8 best_order = i;
+		u8 best_end   = 0;
+		for (u8 j = i; j < scratch.wordhunt_plan.word_count && best_cost; j += 1)
 		{
-			if (letter_bank[bank_letter_index] == word[word_letter_index])
+			u8* entry = &scratch.wordhunt_plan.bytes[scratch.wordhunt_plan.word_offsets[order[j]]];
+			for (u8 k = 0; k < entry[1]; k += 1)
 			{
-				// If a required letter is found in the letter-bank, set the high-bit in the corresponding letter in the letter-bank to `1`.
-				// This bit is unused anyways, and this will make the comparison equality fail for this specific slot of the letter-bank.
-				letter_bank [bank_letter_index] |= 1 << 7;
-				index_buffer[word_letter_index]  = bank_letter_index;
-				goto NEXT_LETTER;
+				u8 cost = get_cell_distance(cursor_cell, entry[2 + k] >> 4);
+				if (cost < best_cost)
+				{
+					best_cost  = cost;
+					best_order = j;
+					best_end   = entry[2 + k];
+				}
 			}
 		}
 
-		valid = false;
-		break;
-
-		NEXT_LETTER:;
+		u8 swapped        = order[i];
+		order[i]          = order[best_order];
+		order[best_order] = swapped;
+		ends[i]           = best_end;
+		cursor_cell       = best_end & 0xF;
 	}
-	for (u8 i = 0; i < ANAGRAMS_MAX_LETTERS; i += 1) // Reset the high-bits of the used letters in the letter-bank back to `0`.
+
+	//
+	// The greedy pick didn't know which word would come after, so the ends of each word get picked once more now that it does.
+	//
+
+	cursor_cell = scratch.wordhunt_plan.cursor_cell;
+	for (u8 i = 0; i < scratch.wordhunt_plan.word_count; i += 1)
 	{
-		letter_bank[i] &= ~(1 << 7);
+		u8* entry           = &scratch.wordhunt_plan.bytes[scratch.wordhunt_plan.word_offsets[order[i]]];
+		u8  next_start_cell = i + 1 < scratch.wordhunt_plan.word_count ? ends[i + 1] >> 4 : WORDHUNT_NO_CELL;
+		u8  best_cost       = 0xFF;
+		for (u8 k = 0; k < entry[1]; k += 1)
+		{
+			u8 cost = get_cell_distance(cursor_cell, entry[2 + k] >> 4) + get_cell_distance(entry[2 + k] & 0xF, next_start_cell);
+			if (cost < best_cost)
+			{
+				best_cost = cost;
+				ends[i]   = entry[2 + k];
+			}
+		}
+		cursor_cell = ends[i] & 0xF;
 	}
 
-	if (valid)
+	//
+	// Find the path between the chosen ends again and play it.
+	//
+
+	for (u8 i = 0; i < scratch.wordhunt_plan.word_count; i += 1)
 	{
-		play_mouse_anagrams(index_buffer, word_length);
+		u8*                  entry       = &scratch.wordhunt_plan.bytes[scratch.wordhunt_plan.word_offsets[order[i]]];
+		u8                   word_length = entry[0];
+		const u8*            word        = &entry[2 + entry[1]];
+		struct WordHuntPaths paths;
+		open_wordhunt_paths(&paths, 1U << (ends[i] >> 4));
+		while (next_wordhunt_path(&paths, word, word_length) && paths.cells[word_length - 1] != (ends[i] & 0xF));
+
+		u8 direction_index_buffer[WORDHUNT_MAX_LETTERS - 1];
+		for (u8 j = 0; j + 1 < word_length; j += 1)
+		{
+			direction_index_buffer[j] = get_direction_index(paths.cells[j], paths.cells[j + 1]);
+		}
+		play_mouse_wordhunt(paths.cells[0] % WORDHUNT_DIMS, paths.cells[0] / WORDHUNT_DIMS, direction_index_buffer, word_length - 1);
 	}
 
-	return valid;
+	scratch.wordhunt_plan.cursor_cell = cursor_cell;
+	scratch.wordhunt_plan.size        = 0;
+	scratch.wordhunt_plan.word_count  = 0;
 }
 
 static
-WordEntryCallback(wordhunt_callback)
+WordEntryCallback(wordhunt_callback) // Expects `init_wordhunt_board` to have been done on `letter_bank`. The word is only planned; `play_wordhunt_plan` plays it.
 {
-	for (i8 curr_y = 0; curr_y < WORDHUNT_DIMS; curr_y += 1)
+	if
+	(
+		scratch.wordhunt_plan.word_count == WORDHUNT_PLAN_MAX_WORDS ||
+		scratch.wordhunt_plan.size + 2 + WORDHUNT_PLAN_MAX_ENDS + word_length > WORDHUNT_PLAN_SIZE
+	)
 	{
-		for (i8 curr_x = 0; curr_x < WORDHUNT_DIMS; curr_x += 1)
+		play_wordhunt_plan();
+	}
+
+	//
+	// Remember the different places that the word can start and end at.
+	//
+
+	u8*                  entry     = &scratch.wordhunt_plan.bytes[scratch.wordhunt_plan.size];
+	u8                   end_count = 0;
+	struct WordHuntPaths paths;
+	open_wordhunt_paths(&paths, scratch.wordhunt_board.letter_cells[word[0] - 'a']);
+	while (end_count < WORDHUNT_PLAN_MAX_ENDS && next_wordhunt_path(&paths, word, word_length))
+	{
+		u8    end      = (paths.cells[0] << 4) | paths.cells[word_length - 1];
+		bool8 repeated = false;
+		for (u8 i = 0; i < end_count; i += 1)
 		{
-			if (letter_bank[curr_y * WORDHUNT_DIMS + curr_x] == word[0])
+			if (entry[2 + i] == end)
 			{
-				letter_bank[curr_y * WORDHUNT_DIMS + curr_x] |= 1 << 7;
+				repeated = true;
+				break;
+			}
+		}
+		if (!repeated)
+		{
+			entry[2 + end_count]  = end;
+			end_count            += 1;
+		}
+	}
 
-				u8 direction_index_buffer[WORDHUNT_MAX_LETTERS - 1];
-				u8 direction_index_count = 0;
-				u8 curr_direction_index  = 0;
-				while (true)
-				{
-					//
-					// Cycle through the directions.
-					//
+	if (!end_count) // The word can't be made on the grid.
+	{
+		return false;
+	}
 
-					while (curr_direction_index < DIRECTIONS_COUNT)
-					{
-						if // Check if we can and should take a step into the direction.
-						(
-							0 <= curr_x + get_direction_dx(curr_direction_index) && curr_x + get_direction_dx(curr_direction_index) < WORDHUNT_DIMS &&
-							0 <= curr_y + get_direction_dy(curr_direction_index) && curr_y + get_direction_dy(curr_direction_index) < WORDHUNT_DIMS &&
-							letter_bank[(curr_y + get_direction_dy(curr_direction_index)) * WORDHUNT_DIMS + curr_x + get_direction_dx(curr_direction_index)] == word[direction_index_count + 1]
-						)
-						{
-							direction_index_buffer[direction_index_count]  = curr_direction_index;
-							direction_index_count                         += 1;
+	entry[0] = word_length;
+	entry[1] = end_count;
+	memcpy(&entry[2 + end_count], word, word_length);
+	scratch.wordhunt_plan.word_offsets[scratch.wordhunt_plan.word_count]  = scratch.wordhunt_plan.size;
+	scratch.wordhunt_plan.word_count                             += 1;
+	scratch.wordhunt_plan.size                                   += 2 + end_count + word_length;
 
-							if (direction_index_count + 1 == word_length) // We got to the end. Note the fencepost math.
-							{
-								for (u8 i = 1; i < direction_index_count; i += 1) // Backtrack to beginning and fix up used letters in the grid.
-								{
-									letter_bank[curr_y * WORDHUNT_DIMS + curr_x] &= ~(1 << 7);
-									curr_x                                       -= get_direction_dx(direction_index_buffer[direction_index_count - 1 - i]);
-									curr_y                                       -= get_direction_dy(direction_index_buffer[direction_index_count - 1 - i]);
-								}
-								letter_bank[curr_y * WORDHUNT_DIMS + curr_x] &= ~(1 << 7);
+	return true;
+}
 
-								play_mouse_wordhunt(curr_x, curr_y, direction_index_buffer, word_length - 1);
+static struct GameSchedule // The game's clock is taken to start now.
+init_game_schedule(bool8 wordhunt)
+{
+	struct GameSchedule schedule = {0};
+	schedule.wordhunt    = wordhunt;
+	schedule.deadline_ms = get_ms() + (wordhunt ? WORDHUNT_GAME_MS : ANAGRAMS_GAME_MS);
+	return schedule;
+}
 
-								return true;
-							}
-							else // Take step forward.
-							{
-								curr_x                                       += get_direction_dx(curr_direction_index);
-								curr_y                                       += get_direction_dy(curr_direction_index);
-								letter_bank[curr_y * WORDHUNT_DIMS + curr_x] |= 1 << 7;
-								curr_direction_index                          = 0;
-							}
-						}
-						else
-						{
-							curr_direction_index += 1;
-						}
-					}
+static u32 // When the mouse would be done with a word of the given length if it were given it now.
+get_scheduled_finish_ms(struct GameSchedule* schedule, u8 word_length)
+{
+	u32 now_ms   = get_ms();
+	u32 start_ms = schedule->finish_ms > now_ms ? schedule->finish_ms : now_ms;
+	return start_ms + mouse_estimate_ms(schedule->wordhunt ? word_length - 1 : word_length);
+}
 
-					//
-					// Backtrack and use the next direction.
-					//
+static bool8 // Words are found longest first, which is also the most points for the time they take, so taking whatever still fits is the greedy pick.
+game_schedule_fits(struct GameSchedule* schedule, u8 word_length)
+{
+	return get_scheduled_finish_ms(schedule, word_length) <= schedule->deadline_ms;
+}
 
-					letter_bank[curr_y * WORDHUNT_DIMS + curr_x] &= ~(1 << 7);
-					if (direction_index_count)
-					{
-						direction_index_count -= 1;
-						curr_x                -= get_direction_dx(direction_index_buffer[direction_index_count]);
-						curr_y                -= get_direction_dy(direction_index_buffer[direction_index_count]);
-						curr_direction_index   = direction_index_buffer[direction_index_count] + 1;
-					}
-					else
-					{
-						break;
-					}
-				}
-			}
-		}
-	}
+static void
+add_to_game_schedule(struct GameSchedule* schedule, u8 word_length)
+{
+	schedule->finish_ms         = get_scheduled_finish_ms(schedule, word_length);
+	schedule->predicted_points += pgm_read_word(schedule->wordhunt ? &WORDHUNT_POINTS[word_length] : &ANAGRAMS_POINTS[word_length]);
+}
 
-	return false;
+static void // Seconds that the mouse has left to be given words, the points it's predicted to get, and then as much of the word as fits.
+set_lcd_to_show_game_schedule(struct LCD* lcd, struct GameSchedule* schedule, u8* word, u8 word_length)
+{
+	u32 now_ms   = get_ms();
+	u32 start_ms = schedule->finish_ms > now_ms ? schedule->finish_ms : now_ms;
+
+	set_lcd_cursor_pos(lcd, 0, 1);
+	lcd_send_u64(lcd, start_ms < schedule->deadline_ms ? (schedule->deadline_ms - start_ms) / 1000 : 0);
+	lcd_send_pstr(lcd, "s ");
+	lcd_send_u64(lcd, schedule->predicted_points);
+	lcd_send_byte(lcd, ' ');
+	lcd_send_bytes(lcd, word, word_length);
 }
 
 int
@@ -589,21 +1683,33 @@ main(void)
 	init_keypad();
 	struct LCD lcd = init_lcd();
 
-	set_pin(MOUSE_SLAVE_SELECT_PIN, PinState_output_high);
-	set_pin(SD_SLAVE_SELECT_PIN   , PinState_output_high);
+	init_mouse();
+	set_pin(SD_SLAVE_SELECT_PIN, PinState_output_high);
+
+	init_flash_bank();
 
+	bool8 has_sd_card = true;
 	{
 		static FATFS file_system;
-		if (f_mount(&file_system, "", 1))
+		if (!f_mount(&file_system, "", 1))
+		{
+			// Good to go.
+		}
+		else if (flash_bank_length_mask)
+		{
+			has_sd_card = false;
+			uart_send_pstr("No SD card, so only the words in flash will be searched for.\n");
+		}
+		else
 		{
 			MAIN_ABORT("`f_mount` failed to initialize the file-system.");
 		}
 	}
 
+	if (has_sd_card)
 	{
-		FIL           bank_file;
-		InitialCounts initial_counts;
-		const char*   error = init_bank_bin(&bank_file, initial_counts, &lcd, false);
+		FIL         bank_file;
+		const char* error = init_bank_bin(&bank_file, &lcd, false);
 		MAIN_ABORT_ON_ERROR(error);
 		if (f_close(&bank_file))
 		{
@@ -662,31 +1768,20 @@ main(void)
 				{
 					callback             = wordhunt_callback;
 					letter_bank_size     = WORDHUNT_MAX_LETTERS;
-					starting_word_length = 9;
+					starting_word_length = WORDHUNT_MAX_LETTERS;
 					game_name            = PSTR("WordHunt");
 				}
 
-				u8            letter_bank_buffer[ABSOLUTE_MAX_LETTERS];
-				FIL           bank_file;
-				InitialCounts initial_counts;
+				u8  letter_bank_buffer[ABSOLUTE_MAX_LETTERS];
+				FIL bank_file;
+				if (has_sd_card)
 				{
-					const char* error = init_bank_bin(&bank_file, initial_counts, &lcd, false);
+					const char* error = init_bank_bin(&bank_file, &lcd, false);
 					MAIN_ABORT_ON_ERROR(error);
-
-					u32 seek_offset = sizeof(InitialCounts);
-					for (u8 word_length = ABSOLUTE_MAX_LETTERS; word_length > starting_word_length; word_length -= 1)
-					{
-						for (u8 word_initial = 'a'; word_initial <= 'z'; word_initial += 1)
-						{
-							seek_offset += initial_counts[ABSOLUTE_MAX_LETTERS - word_length][word_initial - 'a'] * COMPRESSED_WORD_TAIL_LENGTH_FROM_WORD_LENGTH(word_length);
-						}
-					}
-					if (f_lseek(&bank_file, seek_offset))
-					{
-						MAIN_ABORT("Failed to seek \"BANK.BIN\".");
-					}
 				}
 
+				struct GameSchedule schedule = init_game_schedule(menu_option == MenuOption_wordhunt); // The game is started right before its letters are put in.
+
 				struct WordEntry
 				{
 					u8  length;
@@ -697,54 +1792,431 @@ main(void)
 				u32 letter_mask      = query_letters_nonliteral(&lcd, game_name, letter_bank_buffer, letter_bank_size);
 				if (letter_mask)
 				{
-					{ // Search for words.
-						u32 seek_offset_addend  = 0;
-						u16 lcd_buffering_tick  = 0;
-						u32 keypad_held_time_ms = 0;
-						u8  keypad_held_tick    = 0;
-						u32 starting_time_ms    = get_ms();
+					if (menu_option == MenuOption_anagrams)
+					{
+						init_anagrams_rack(letter_bank_buffer);
+					}
+					else if (menu_option == MenuOption_wordhunt)
+					{
+						init_wordhunt_board(letter_bank_buffer);
+					}
+
+					bool8 answered_by_racks = false;
+					if // "RACKS.BIN" already has the answers for every rack, so there's no searching needed (unless it's all in flash anyway).
+					(
+						menu_option == MenuOption_anagrams && has_sd_card &&
+						(flash_bank_length_mask & ANAGRAMS_LENGTH_MASK) != ANAGRAMS_LENGTH_MASK
+					)
+					{
+						FIL racks_file;
+						if (f_open(&racks_file, "RACKS.BIN", FA_READ) == FR_OK)
+						{
+							u32 magic;
+							u16 version;
+							if
+							(
+								sd_fread(&racks_file, &magic, sizeof(magic)) && magic == RACKS_BIN_MAGIC &&
+								sd_fread(&racks_file, &version, sizeof(version)) && version == RACKS_BIN_VERSION
+							)
+							{
+								u8 sorted_letters[ANAGRAMS_MAX_LETTERS];
+								i8 sorted_indices[ANAGRAMS_MAX_LETTERS]; // Where each of `sorted_letters` is in `letter_bank_buffer`.
+								for (u8 i = 0; i < ANAGRAMS_MAX_LETTERS; i += 1)
+								{
+									u8 j = i;
+									while (j && sorted_letters[j - 1] > letter_bank_buffer[i])
+									{
+										sorted_letters[j] = sorted_letters[j - 1];
+										sorted_indices[j] = sorted_indices[j - 1];
+										j -= 1;
+									}
+									sorted_letters[j] = letter_bank_buffer[i];
+									sorted_indices[j] = i;
+								}
+
+								u32 answer_bounds[2];
+								if
+								(
+									f_lseek(&racks_file, RACKS_BIN_OFFSETS_POSITION + get_rack_rank(sorted_letters) * sizeof(u32)) ||
+									!sd_fread(&racks_file, answer_bounds, sizeof(answer_bounds)) ||
+									f_lseek(&racks_file, answer_bounds[0])
+								)
+								{
+									MAIN_ABORT("Failed to look up the rack in \"RACKS.BIN\".");
+								}
+
+								//
+								// The tiles of every answer are checked before any of them are played, since they index into the rack.
+								// A bad "RACKS.BIN" then falls back to the search without the mouse having already been given part of it.
+								//
+
+								bool8 answers_valid = true;
+								while (answers_valid && f_tell(&racks_file) < answer_bounds[1])
+								{
+									u8 word_length;
+									u8 tiles[ANAGRAMS_MAX_LETTERS];
+									if
+									(
+										!sd_fread(&racks_file, &word_length, sizeof(word_length)) ||
+										word_length < MIN_LETTERS || word_length > ANAGRAMS_MAX_LETTERS ||
+										f_lseek(&racks_file, f_tell(&racks_file) + sizeof(u16)) ||
+										!sd_fread(&racks_file, tiles, word_length)
+									)
+									{
+										answers_valid = false;
+									}
+									for (u8 i = 0; answers_valid && i < word_length; i += 1)
+									{
+										answers_valid = tiles[i] < ANAGRAMS_MAX_LETTERS;
+									}
+								}
+								if (!answers_valid)
+								{
+									uart_send_pstr("\"RACKS.BIN\" has a bad answer for the rack, so it'll be searched for instead.\n");
+								}
+								else if (f_lseek(&racks_file, answer_bounds[0]))
+								{
+									MAIN_ABORT("Failed to seek \"RACKS.BIN\".");
+								}
+
+								u32 keypad_held_time_ms = 0;
+								u8  keypad_held_tick    = 0;
+								u32 starting_time_ms    = get_ms();
+								while (answers_valid && f_tell(&racks_file) < answer_bounds[1] && word_entry_count < countof(word_entry_buffer))
+								{
+									mouse_pump();
+									if (keypad_held(&keypad_held_time_ms, &keypad_held_tick))
+									{
+										break;
+									}
+
+									u8  word_length;
+									u16 initial_index;
+									u8  tiles[ANAGRAMS_MAX_LETTERS];
+									if
+									(
+										!sd_fread(&racks_file, &word_length, sizeof(word_length)) || word_length > ANAGRAMS_MAX_LETTERS ||
+										!sd_fread(&racks_file, &initial_index, sizeof(initial_index)) ||
+										!sd_fread(&racks_file, tiles, word_length)
+									)
+									{
+										MAIN_ABORT("Failed to read \"RACKS.BIN\".");
+									}
+
+									//
+									// Get the word out of "BANK.BIN" to make sure it hasn't been removed.
+									//
+
+									u8 word_buffer[ANAGRAMS_MAX_LETTERS];
+									word_buffer[0] = sorted_letters[tiles[0]];
+
+									struct BankBucket bucket;
+									const char*       error = lookup_bank_bucket(&bucket, &bank_file, word_length, word_buffer[0]);
+									MAIN_ABORT_ON_ERROR(error);
+									if (initial_index >= bucket.count)
+									{
+										MAIN_ABORT("\"RACKS.BIN\" wasn't made from the same \"WORDS.TXT\" as \"BANK.BIN\".");
+									}
+
+									union CompressedWordTailBuffer compressed_word_tail_buffer;
+									if
+									(
+										f_lseek(&bank_file, bucket.offset + (u32) initial_index * BANK_RECORD_SIZE(word_length) + sizeof(u32)) ||
+										!sd_fread(&bank_file, &compressed_word_tail_buffer, COMPRESSED_WORD_TAIL_LENGTH_FROM_WORD_LENGTH(word_length))
+									)
+									{
+										MAIN_ABORT("Failed to read a word from \"BANK.BIN\".");
+									}
+
+									if (!game_schedule_fits(&schedule, word_length))
+									{
+										if (!game_schedule_fits(&schedule, MIN_LETTERS)) // Not even the shortest word can be played in time anymore.
+										{
+											break;
+										}
+										continue;
+									}
+
+									if (decompress_word(word_buffer, word_length, compressed_word_tail_buffer.elems_u8))
+									{
+										i8 index_buffer[ANAGRAMS_MAX_LETTERS];
+										for (u8 i = 0; i < word_length; i += 1)
+										{
+											index_buffer[i] = sorted_indices[tiles[i]];
+										}
+										play_mouse_anagrams(index_buffer, word_length);
+										add_to_game_schedule(&schedule, word_length);
+
+										word_entry_buffer[word_entry_count]  = (struct WordEntry) { .length = word_length, .initial = word_buffer[0], .index = initial_index };
+										word_entry_count                    += 1;
+
+										uart_send_bytes(word_buffer, word_length);
+										uart_send_pstr("\n");
+
+										clean_lcd(&lcd);
+										lcd_send_bytes(&lcd, letter_bank_buffer, letter_bank_size);
+										set_lcd_to_show_game_schedule(&lcd, &schedule, word_buffer, word_length);
+										swap_lcd_backbuffer(&lcd);
+									}
+								}
+
+								uart_send_pstr("Looking up the rack took: ");
+								uart_send_u64(get_ms() - starting_time_ms);
+								uart_send_pstr("ms.\n");
+								sd_report_cache();
+								report_stack();
+
+								answered_by_racks = answers_valid;
+							}
+
+							if (f_close(&racks_file))
+							{
+								MAIN_ABORT("Failed to close \"RACKS.BIN\".");
+							}
+						}
+					}
+
+					if (!answered_by_racks) // Search for words.
+					{
+						union // The words come from "TRIE.BIN" if there is one, otherwise it's the slower scan through all of "BANK.BIN".
+						{
+							struct SDWindow bank_window;
+							struct
+							{
+								FIL             file;
+								struct TrieWalk walk;
+							} trie;
+						} source;
+
+						bool8 using_trie = false;
+						if (has_sd_card && f_open(&source.trie.file, "TRIE.BIN", FA_READ) == FR_OK)
+						{
+							u32 magic;
+							u16 version;
+							using_trie =
+								sd_fread(&source.trie.file, &magic, sizeof(magic)) && magic == TRIE_BIN_MAGIC &&
+								sd_fread(&source.trie.file, &version, sizeof(version)) && version == TRIE_BIN_VERSION;
+							if (!using_trie && f_close(&source.trie.file))
+							{
+								MAIN_ABORT("Failed to close \"TRIE.BIN\".");
+							}
+						}
+
+						u32 letter_bank_signature = get_word_signature(letter_bank_buffer, letter_bank_size);
+						u16 lcd_buffering_tick    = 0;
+						u32 keypad_held_time_ms   = 0;
+						u8  keypad_held_tick      = 0;
+						u32 starting_time_ms      = get_ms();
 						for (u8 word_length = starting_word_length; word_length >= MIN_LETTERS; word_length -= 1)
 						{
+							bool8 from_flash = !!(flash_bank_length_mask & (1UL << word_length));
+							if
+							(
+								!from_flash &&
+								(
+									!has_sd_card ||
+									(!using_trie && menu_option == MenuOption_wordhunt && word_length > WORDHUNT_SCAN_MAX_LETTERS)
+								)
+							)
+							{
+								continue;
+							}
+
 							for (u8 word_initial = 'a'; word_initial <= 'z'; word_initial += 1)
 							{
 								if (letter_mask & (1UL << (word_initial - 'a'))) // If this initial is even one of the user-provided letters.
 								{
-									if (seek_offset_addend) // In the case the we have skipped over some initial sections.
+									struct BankBucket bucket;
+									struct BankBucket removal_bucket       = {0}; // Where the bucket from flash is in "BANK.BIN", which is where removed words are marked.
+									uint_farptr_t     flash_bucket_address = 0;
+									const char*       error                = 0;
+									if (from_flash)
+									{
+										flash_bucket_address = lookup_flash_bucket(&bucket, word_length, word_initial);
+										if (has_sd_card)
+										{
+											error = lookup_bank_bucket(&removal_bucket, &bank_file, word_length, word_initial);
+											MAIN_ABORT_ON_ERROR(error);
+										}
+									}
+									else
+									{
+										error = lookup_bank_bucket(&bucket, &bank_file, word_length, word_initial);
+										MAIN_ABORT_ON_ERROR(error);
+									}
+
+									u16 sub_bucket_starts['z' - 'a' + 2];
+									if (from_flash)
 									{
-										if (f_lseek(&bank_file, f_tell(&bank_file) + seek_offset_addend))
+										// Flash is just read straight through.
+									}
+									else if (using_trie)
+									{
+										error = open_trie_walk(&source.trie.walk, &source.trie.file, word_length, word_initial, letter_bank_buffer, letter_bank_size, menu_option == MenuOption_wordhunt);
+										MAIN_ABORT_ON_ERROR(error);
+									}
+									else if (bucket.count)
+									{
+										error = lookup_bank_sub_buckets(sub_bucket_starts, &bank_file, &bucket, word_length, word_initial);
+										MAIN_ABORT_ON_ERROR(error);
+										if (f_lseek(&bank_file, bucket.offset))
 										{
 											MAIN_ABORT("Failed to seek \"BANK.BIN\".");
 										}
-										seek_offset_addend = 0;
+										sd_window_open(&source.bank_window, &bank_file);
 									}
 
-									u8 word_buffer[ABSOLUTE_MAX_LETTERS];
+									u8  word_buffer[ABSOLUTE_MAX_LETTERS];
+									u16 next_initial_index = 0;
+									u16 sub_bucket_end     = 0;
+									u8  second_index       = 0; // Of the sub-bucket after the current one.
 									word_buffer[0] = word_initial;
-									for (u16 initial_index = 0; initial_index < initial_counts[ABSOLUTE_MAX_LETTERS - word_length][word_initial - 'a']; initial_index += 1)
+									while (true)
 									{
+										mouse_pump(); // Keeps the mouse busy with what's been found so far.
+										if (menu_option == MenuOption_wordhunt && scratch.wordhunt_plan.word_count >= WORDHUNT_PLAN_MIN_WORDS && mouse_idle())
+										{
+											play_wordhunt_plan(); // Better than leaving the mouse with nothing to do while waiting on more words to plan with.
+										}
 										if (keypad_held(&keypad_held_time_ms, &keypad_held_tick))
 										{
 											goto STOP_SEARCHING;
 										}
 
-										union CompressedWordTailBuffer compressed_word_tail_buffer;
-										if (!sd_fread(&bank_file, &compressed_word_tail_buffer, COMPRESSED_WORD_TAIL_LENGTH_FROM_WORD_LENGTH(word_length)))
+										u16   initial_index;
+										bool8 word_exists;
+										if (using_trie && !from_flash) // The trie only has the words that can be made out of the letters, but they might have since been removed from "BANK.BIN".
 										{
-											uart_send_pstr("Failed to read a word from \"BANK.BIN\".\n");
-											goto ABORT;
+											bool8 found;
+											error = next_trie_word(&source.trie.walk, &initial_index, &found);
+											MAIN_ABORT_ON_ERROR(error);
+											if (!found)
+											{
+												break;
+											}
+
+											if (source.trie.walk.on_grid) // The same word can be found again along another path, so skip it if it's already been played.
+											{
+												bool8 repeated = false;
+												for (u16 i = word_entry_count; i && word_entry_buffer[i - 1].length == word_length && word_entry_buffer[i - 1].initial == word_initial; i -= 1)
+												{
+													if (word_entry_buffer[i - 1].index == initial_index)
+													{
+														repeated = true;
+														break;
+													}
+												}
+												if (repeated)
+												{
+													continue;
+												}
+											}
+
+											union CompressedWordTailBuffer compressed_word_tail_buffer;
+											if
+											(
+												f_lseek(&bank_file, bucket.offset + (u32) initial_index * BANK_RECORD_SIZE(word_length) + sizeof(u32)) ||
+												!sd_fread(&bank_file, &compressed_word_tail_buffer, COMPRESSED_WORD_TAIL_LENGTH_FROM_WORD_LENGTH(word_length))
+											)
+											{
+												uart_send_pstr("Failed to read a word from \"BANK.BIN\".\n");
+												goto ABORT;
+											}
+											word_exists = decompress_word(word_buffer, word_length, compressed_word_tail_buffer.elems_u8);
 										}
-										if (decompress_word(word_buffer, word_length, &compressed_word_tail_buffer))
+										else
 										{
-											for (u8 i = 1; i < word_length; i += 1)
+											const u8* record;
+											u8        flash_record[BANK_RECORD_SIZE(ABSOLUTE_MAX_LETTERS) + 1]; // `decompress_word` might read the byte after the tail.
+											if (from_flash)
+											{
+												if (next_initial_index == bucket.count)
+												{
+													break;
+												}
+												memcpy_PF(flash_record, flash_bucket_address + (u32) next_initial_index * BANK_RECORD_SIZE(word_length), BANK_RECORD_SIZE(word_length));
+												record = flash_record;
+											}
+											else if (next_initial_index == sub_bucket_end) // Skip the sub-buckets whose second letter can't follow the initial.
+											{
+												while (second_index < 'z' - 'a' + 1 && !letter_pair_fits(word_initial - 'a', second_index))
+												{
+													second_index += 1;
+												}
+												if (second_index == 'z' - 'a' + 1 || !bucket.count)
+												{
+													break;
+												}
+
+												if (!sd_window_skip(&source.bank_window, (u32) (sub_bucket_starts[second_index] - next_initial_index) * BANK_RECORD_SIZE(word_length)))
+												{
+													MAIN_ABORT("Failed to seek \"BANK.BIN\".");
+												}
+												next_initial_index  = sub_bucket_starts[second_index];
+												sub_bucket_end      = sub_bucket_starts[second_index + 1];
+												second_index       += 1;
+												continue;
+											}
+											else
+											{
+												record = sd_window_take(&source.bank_window, BANK_RECORD_SIZE(word_length));
+												if (!record)
+												{
+													uart_send_pstr("Failed to read a word from \"BANK.BIN\".\n");
+													goto ABORT;
+												}
+											}
+											initial_index       = next_initial_index;
+											next_initial_index += 1;
+
+											u32 word_signature;
+											memcpy(&word_signature, record, sizeof(word_signature));
+											if (!word_signature_fits(word_signature, letter_bank_signature)) // Most words don't, so they're skipped before anything else is done.
+											{
+												continue;
+											}
+											if (!compressed_word_tail_fits(record + sizeof(u32), word_length, word_initial)) // Then most of the rest are caught by letters that can't be next to each other.
+											{
+												continue;
+											}
+
+											word_exists = decompress_word(word_buffer, word_length, record + sizeof(u32));
+
+											if (word_exists && from_flash && has_sd_card) // Flash can't be written to, so the word might have been removed from "BANK.BIN" since.
 											{
-												if (!(letter_mask & (1UL << (word_buffer[i] - 'a'))))
+												if (initial_index >= removal_bucket.count)
+												{
+													MAIN_ABORT("\"FLASH.BIN\" wasn't made from the same \"WORDS.TXT\" as \"BANK.BIN\".");
+												}
+
+												u8 first_tail_byte;
+												if
+												(
+													f_lseek(&bank_file, removal_bucket.offset + (u32) initial_index * BANK_RECORD_SIZE(word_length) + sizeof(u32)) ||
+													!sd_fread(&bank_file, &first_tail_byte, sizeof(first_tail_byte))
+												)
 												{
-													goto NEXT_WORD;
+													MAIN_ABORT("Failed to read a word from \"BANK.BIN\".");
 												}
+												word_exists = first_tail_byte != 0xFF;
+											}
+										}
+
+										if (word_exists && !game_schedule_fits(&schedule, word_length))
+										{
+											if (!game_schedule_fits(&schedule, MIN_LETTERS)) // Not even the shortest word can be played in time anymore.
+											{
+												goto STOP_SEARCHING;
 											}
+											word_exists = false;
+										}
 
-											if (callback(letter_bank_buffer, word_buffer, word_length)) // If the algorithm determined and has acted, we remember this word for later prompting.
+										if (word_exists)
+										{
+											bool8 played = callback(letter_bank_buffer, word_buffer, word_length); // Even with the trie's walk along the grid, WordHunt still looks for every path so the planner can choose.
+											if (played) // If the algorithm determined and has acted, we remember this word for later prompting.
 											{
+												add_to_game_schedule(&schedule, word_length);
 												word_entry_buffer[word_entry_count]  = (struct WordEntry) { .length = word_length, .initial = word_initial, .index = initial_index };
 												word_entry_count                    += 1;
 												if (word_entry_count == countof(word_entry_buffer))
@@ -758,56 +2230,55 @@ main(void)
 												lcd_buffering_tick = 0;
 											}
 
-											NEXT_WORD:;
-
 											if (lcd_buffering_tick == 0)
 											{
 												clean_lcd(&lcd);
 												lcd_send_bytes(&lcd, letter_bank_buffer, letter_bank_size);
-												set_lcd_cursor_pos(&lcd, 0, 1);
-												lcd_send_bytes(&lcd, word_buffer, word_length);
+												set_lcd_to_show_game_schedule(&lcd, &schedule, word_buffer, word_length);
 												swap_lcd_backbuffer(&lcd);
 											}
 											lcd_buffering_tick += 32;
 										}
 									}
 								}
-								else
-								{
-									seek_offset_addend += initial_counts[ABSOLUTE_MAX_LETTERS - word_length][word_initial - 'a'] * COMPRESSED_WORD_TAIL_LENGTH_FROM_WORD_LENGTH(word_length);
-								}
 							}
 						}
 						STOP_SEARCHING:;
 
+						if (using_trie && f_close(&source.trie.file))
+						{
+							MAIN_ABORT("Failed to close \"TRIE.BIN\".");
+						}
+
 						uart_send_pstr("Searching took: ");
 						uart_send_u64(get_ms() - starting_time_ms);
 						uart_send_pstr("ms.\n");
+						sd_report_cache();
+						report_stack();
+					}
+
+					if (menu_option == MenuOption_wordhunt)
+					{
+						play_wordhunt_plan();
 					}
+					mouse_flush(); // Finish playing before asking about the words.
+
+					uart_send_pstr("Predicted score: ");
+					uart_send_u64(schedule.predicted_points);
+					uart_send_pstr(".\n");
 
-					for (u16 word_entry_index = 0; word_entry_index < word_entry_count; word_entry_index += 1)
+					for (u16 word_entry_index = 0; has_sd_card && word_entry_index < word_entry_count; word_entry_index += 1) // Words can only be removed from "BANK.BIN".
 					{
 						//
 						// Go to where the word is in the file.
 						//
 
-						u32 seek_offset = sizeof(InitialCounts);
-						for (u8 seek_length = ABSOLUTE_MAX_LETTERS; seek_length > word_entry_buffer[word_entry_index].length; seek_length -= 1)
-						{
-							for (u8 seek_initial = 'a'; seek_initial <= 'z'; seek_initial += 1)
-							{
-								seek_offset += initial_counts[ABSOLUTE_MAX_LETTERS - seek_length][seek_initial - 'a'] * COMPRESSED_WORD_TAIL_LENGTH_FROM_WORD_LENGTH(seek_length);
-							}
-						}
-						for (u8 seek_initial = 'a'; seek_initial < word_entry_buffer[word_entry_index].initial; seek_initial += 1)
-						{
-							seek_offset += initial_counts[ABSOLUTE_MAX_LETTERS - word_entry_buffer[word_entry_index].length][seek_initial - 'a'] * COMPRESSED_WORD_TAIL_LENGTH_FROM_WORD_LENGTH(word_entry_buffer[word_entry_index].length);
-						}
-						seek_offset += word_entry_buffer[word_entry_index].index * COMPRESSED_WORD_TAIL_LENGTH_FROM_WORD_LENGTH(word_entry_buffer[word_entry_index].length);
-
-						if (f_lseek(&bank_file, seek_offset))
+						struct BankBucket bucket;
+						const char*       error = lookup_bank_bucket(&bucket, &bank_file, word_entry_buffer[word_entry_index].length, word_entry_buffer[word_entry_index].initial);
+						MAIN_ABORT_ON_ERROR(error);
+						if (f_lseek(&bank_file, bucket.offset + (u32) word_entry_buffer[word_entry_index].index * BANK_RECORD_SIZE(word_entry_buffer[word_entry_index].length) + sizeof(u32)))
 						{
-							MAIN_ABORT("Failed to seek \"MID.BIN\".");
+							MAIN_ABORT("Failed to seek \"BANK.BIN\".");
 						}
 
 						//
@@ -822,7 +2293,7 @@ main(void)
 							uart_send_pstr("Failed to read a word from \"BANK.BIN\".\n");
 							goto ABORT;
 						}
-						if (decompress_word(word_buffer, word_entry_buffer[word_entry_index].length, &compressed_word_tail_buffer))
+						if (decompress_word(word_buffer, word_entry_buffer[word_entry_index].length, compressed_word_tail_buffer.elems_u8))
 						{
 							clean_lcd(&lcd);
 							lcd_send_pstr(&lcd, "* to invalidate");
@@ -872,7 +2343,7 @@ main(void)
 					set_lcd_to_show_success_nonliteral(&lcd, game_name);
 				}
 
-				if (f_close(&bank_file))
+				if (has_sd_card && f_close(&bank_file))
 				{
 					MAIN_ABORT("Failed to close \"BANK.BIN\".");
 				}
@@ -892,6 +2363,7 @@ main(void)
 				play_mouse_anagrams((i8[]){ 0, 1, 2, 3, 4, 5 }, 6);
 				play_mouse_anagrams((i8[]){ 1, 3, 5, 0, 2, 4 }, 6);
 				play_mouse_wordhunt(3, 3, (u8[]) { 0, 4, 5, 3, 1, 2, 6, 7 }, 8);
+				mouse_flush();
 
 				set_lcd_to_show_success(&lcd, "Mouse tested!");
 			} break;
@@ -948,11 +2420,14 @@ main(void)
 				} input;
 				if (query_letters(&lcd, "Password?", input.bytes, countof(input.bytes)))
 				{
-					if (input.packed == 7305508620784263523ULL)
+					if (!has_sd_card)
+					{
+						set_lcd_to_show_failure(&lcd, "No SD card");
+					}
+					else if (input.packed == 7305508620784263523ULL)
 					{
-						FIL           bank_file;
-						InitialCounts initial_counts;
-						const char*   error = init_bank_bin(&bank_file, initial_counts, &lcd, true);
+						FIL         bank_file;
+						const char* error = init_bank_bin(&bank_file, &lcd, true);
 						MAIN_ABORT_ON_ERROR(error);
 						if (f_close(&bank_file))
 						{
@@ -1,31 +1,366 @@
-#define MOUSE_SLAVE_SELECT_PIN 31
+// Refer to:
+// - "ATmega2560 Datasheet" ("(pg. N)" refers to page number `N` of this resource)
 
-static void
-play_mouse_anagrams(i8* index_buffer, u8 word_length)
+#ifndef MOUSE_USART_SPI
+#define MOUSE_USART_SPI 0 // When `1`, the mouse is on USART1 in Master SPI Mode instead of sharing the SPI bus with the SD card.
+#endif
+#ifndef MOUSE_PACKET_VERSION
+#define MOUSE_PACKET_VERSION 1 // Must be what the ATmega32U4's firmware takes. `1` is the original packet of a single word; `2` batches words and needs firmware that knows it.
+#endif
+#define MOUSE_SLAVE_SELECT_PIN   31
+#define MOUSE_READY_PIN          21                     // The ATmega32U4 pulls this low as soon as a packet starts coming in and lets it back up once it's done playing it. Pulled up, so it always reads ready if it isn't wired.
+#define MOUSE_SPI_CLOCK          SPIClock_div32         // The ATmega32U4 handles each byte in an interrupt, so the clock is kept at what has been tested to work.
+#define MOUSE_QUEUE_SIZE         128                    // Bytes of words waiting to be sent. Must be a power of two and fit the biggest word.
+#if MOUSE_PACKET_VERSION == 1
+#define MOUSE_WORD_MAX_SIZE      (3 + 15)               // A WordHunt word of 16 letters.
+#else
+#define MOUSE_PACKET_HEADER_SIZE 3
+#define MOUSE_WORD_MAX_SIZE      (2 + (15 * 3 + 7) / 8) // A WordHunt word of 16 letters.
+#endif
+#define MOUSE_WORD_MS            300                    // How long the ATmega32U4 takes to get to a word and be done with it, on top of its steps.
+#define MOUSE_STEP_MS            100                    // Starting guess at how long each tile or direction takes. It's refined by timing the packets that get played.
+
+_Static_assert(MOUSE_QUEUE_SIZE && !(MOUSE_QUEUE_SIZE & (MOUSE_QUEUE_SIZE - 1)) && MOUSE_QUEUE_SIZE <= 256, "`MOUSE_QUEUE_SIZE` must be a power of two that `u8` indices can wrap around.");
+
+//
+// Words are queued up and sent in the background, so a search can keep going while the mouse is still playing the words
+// it found earlier. `mouse_pump` has to be called every so often to start sending the next packet once the ATmega32U4 is
+// ready for it.
+//
+// With `MOUSE_PACKET_VERSION` of `1`, each word is a packet of its own and is sent as it was queued:
+//     [`0` for Anagrams or `1` for WordHunt in the high-bit, byte count of the rest in the low bits] [start_x] [start_y] [indices...]
+// where only WordHunt words have `start_x` and `start_y`, and each tile or direction index is a whole byte.
+//
+// With `MOUSE_PACKET_VERSION` of `2`, a packet carries every word that was queued by the time it started, all within a
+// single slave-select:
+//     [version] [sequence number] [byte count of the words] [words...] [checksum]
+// The sequence number goes up by one each packet so that a dropped or repeated packet can be noticed, and the checksum
+// is whatever makes all the bytes of the packet add up to zero (mod 256).
+//
+// Each word starts with a byte whose high-bit is set high for WordHunt and low for Anagrams, and whose low bits are the
+// count of tiles or directions. A WordHunt word then has a byte with `start_x` in the low nibble and `start_y` in the high
+// nibble. Then come the tile or direction indices at 3 bits each, starting from the least significant bit of each byte.
+//
+
+static volatile u8 _mouse_queue[MOUSE_QUEUE_SIZE];
+static volatile u8 _mouse_queue_head             = 0; // Next byte to be sent. Only moved by the interrupt.
+static volatile u8 _mouse_queue_tail             = 0; // Where the next byte will be queued. Only moved by `_mouse_enqueue`.
+static volatile u8 _mouse_packet_bytes_left      = 0;
+#if MOUSE_PACKET_VERSION != 1
+static          u8 _mouse_packet_header[MOUSE_PACKET_HEADER_SIZE];
+static volatile u8 _mouse_packet_bytes_sent      = 0;
+static volatile u8 _mouse_packet_checksum        = 0;
+static          u8 _mouse_packet_sequence_number = 0;
+#endif
+
+static u16   _mouse_step_ms         = MOUSE_STEP_MS;
+static u8    _mouse_queued_words    = 0;     // What's been queued for the next packet, so the packet knows how much it's asking to be played.
+static u16   _mouse_queued_steps    = 0;
+static u8    _mouse_timed_words     = 0;     // What's in the packet that's being timed from when it started being sent until the ready pin goes back up.
+static u16   _mouse_timed_steps     = 0;
+static u32   _mouse_timed_start_ms  = 0;
+static bool8 _mouse_timed_ready_low = false; // Without the ready wire, there's no telling how long the packet took to play.
+
+#if MOUSE_PACKET_VERSION == 1
+
+static inline __attribute__((always_inline)) u8 // Gives the interrupt the next byte of the packet being sent.
+_mouse_next_packet_byte(void)
 {
-	set_pin(MOUSE_SLAVE_SELECT_PIN, PinState_output_low);
+	u8 value                  = _mouse_queue[_mouse_queue_head];
+	_mouse_queue_head         = (_mouse_queue_head + 1) % MOUSE_QUEUE_SIZE;
+	_mouse_packet_bytes_left -= 1;
+	return value;
+}
 
-	spi_transmit_byte((0 << 7) | word_length); // High-bit set low indicates an Anagrams packet.
-	for (u8 i = 0 ; i < word_length; i += 1)
+static void // Takes the word at the front of the queue as the next packet.
+_mouse_begin_packet(void)
+{
+	u8 header = _mouse_queue[_mouse_queue_head];
+	u8 steps  = header & ~(1 << 7);
+	if (header >> 7) // A WordHunt word's count includes `start_x` and `start_y`.
 	{
-		spi_transmit_byte(index_buffer[i]);
+		steps -= 2;
 	}
 
-	set_pin(MOUSE_SLAVE_SELECT_PIN, PinState_output_high);
+	_mouse_packet_bytes_left = 1 + (header & ~(1 << 7));
+
+	_mouse_timed_words      = 1;
+	_mouse_timed_steps      = steps;
+	_mouse_timed_start_ms   = get_ms();
+	_mouse_timed_ready_low  = false;
+	_mouse_queued_words    -= 1;
+	_mouse_queued_steps    -= steps;
 }
 
-static void
-play_mouse_wordhunt(u8 start_x, u8 start_y, u8* direction_index_buffer, u8 direction_index_count)
+#else
+
+static inline __attribute__((always_inline)) u8 // Gives the interrupt the next byte of the packet being sent.
+_mouse_next_packet_byte(void)
+{
+	u8 value;
+	if (_mouse_packet_bytes_sent < MOUSE_PACKET_HEADER_SIZE)
+	{
+		value = _mouse_packet_header[_mouse_packet_bytes_sent];
+	}
+	else if (_mouse_packet_bytes_left == 1)
+	{
+		value = -_mouse_packet_checksum;
+	}
+	else
+	{
+		value             = _mouse_queue[_mouse_queue_head];
+		_mouse_queue_head = (_mouse_queue_head + 1) % MOUSE_QUEUE_SIZE;
+	}
+
+	_mouse_packet_checksum   += value;
+	_mouse_packet_bytes_sent += 1;
+	_mouse_packet_bytes_left -= 1;
+	return value;
+}
+
+static void // Wraps up everything that's been queued into the next packet.
+_mouse_begin_packet(void)
+{
+	u8 word_bytes = (u8) (_mouse_queue_tail - _mouse_queue_head) % MOUSE_QUEUE_SIZE;
+
+	_mouse_packet_header[0]        = MOUSE_PACKET_VERSION;
+	_mouse_packet_header[1]        = _mouse_packet_sequence_number;
+	_mouse_packet_header[2]        = word_bytes;
+	_mouse_packet_sequence_number += 1;
+	_mouse_packet_bytes_sent       = 0;
+	_mouse_packet_bytes_left       = MOUSE_PACKET_HEADER_SIZE + word_bytes + 1; // `+ 1` for the checksum.
+	_mouse_packet_checksum         = 0;
+
+	_mouse_timed_words     = _mouse_queued_words;
+	_mouse_timed_steps     = _mouse_queued_steps;
+	_mouse_timed_start_ms  = get_ms();
+	_mouse_timed_ready_low = false;
+	_mouse_queued_words    = 0;
+	_mouse_queued_steps    = 0;
+}
+
+#endif
+
+static bool8 _mouse_busy(void);
+
+static void // Refines `_mouse_step_ms` once the packet being timed has been played.
+_mouse_time_packet(void)
+{
+	if (!_mouse_timed_words)
+	{
+		return;
+	}
+
+	if (!read_pin(MOUSE_READY_PIN))
+	{
+		_mouse_timed_ready_low = true;
+	}
+	else if (!_mouse_busy())
+	{
+		u32 elapsed_ms = get_ms() - _mouse_timed_start_ms;
+		u32 words_ms   = (u32) _mouse_timed_words * MOUSE_WORD_MS;
+		if (_mouse_timed_ready_low && _mouse_timed_steps && elapsed_ms > words_ms)
+		{
+			u32 step_ms = (elapsed_ms - words_ms) / _mouse_timed_steps;
+			if (step_ms > 0xFFFF)
+			{
+				step_ms = 0xFFFF;
+			}
+			_mouse_step_ms = ((u32) _mouse_step_ms * 3 + step_ms) / 4; // Smoothed, since a packet of a few words doesn't say much.
+		}
+		_mouse_timed_words = 0;
+	}
+}
+
+static u32 // Predicted time for the ATmega32U4 to play a word of the given number of tiles (Anagrams) or directions (WordHunt).
+mouse_estimate_ms(u8 step_count)
+{
+	return MOUSE_WORD_MS + (u32) _mouse_step_ms * step_count;
+}
+
+#if MOUSE_USART_SPI
+
+//
+// USART1 in Master SPI Mode (pg. 232) is a bus of its own, so a packet can go out while the SD card is being read.
+// TXD1 (pin 18) is MOSI and XCK1 (PD5) is SCK. The ATmega32U4 only listens, so RXD1 (pin 19) is left alone.
+// XCK1 isn't broken out on the Arduino ATmega2560 R3 board, so SCK has to be wired to the chip's pin 78 directly.
+//
+
+static volatile bool8 _mouse_sending = false; // Set from when the slave is selected until the last bit of the packet is out.
+
+ISR (USART1_UDRE_vect) // "USART Data Register Empty" interrupt (pg. 105). The transmitter is double-buffered, so the next byte is loaded while the last one is still shifting out.
 {
+	UDR1 = _mouse_next_packet_byte();
+
+	if (!_mouse_packet_bytes_left)
+	{
+		UCSR1A = 1 << TXC1;                                 // Any "Transmit Complete" flag from before was just a gap between bytes (pg. 236).
+		UCSR1B = (UCSR1B & ~(1 << UDRIE1)) | (1 << TXCIE1); // Wait for the last byte to leave the shift register (pg. 237).
+	}
+}
+
+ISR (USART1_TX_vect) // "USART Transmit Complete" interrupt (pg. 105). Clears "TXC1" by itself.
+{
+	UCSR1B         &= ~(1 << TXCIE1);
+	PORTC          |= 1 << PORTC6; // `MOUSE_SLAVE_SELECT_PIN` raised with a single "sbi" rather than `set_pin`'s read-modify-write of the whole port.
+	_mouse_sending  = false;
+}
+
+static void // Starts sending the next packet if anything is queued and the ATmega32U4 is ready.
+mouse_pump(void)
+{
+	_mouse_time_packet();
+	if (_mouse_queue_head == _mouse_queue_tail || _mouse_sending || !read_pin(MOUSE_READY_PIN))
+	{
+		return;
+	}
+
+	_mouse_sending  = true;
+	_mouse_begin_packet();
 	set_pin(MOUSE_SLAVE_SELECT_PIN, PinState_output_low);
+	UCSR1B         |= 1 << UDRIE1; // "USART Data Register Empty Interrupt Enable" (pg. 237). Fires right away since nothing is being sent.
+}
+
+static bool8
+_mouse_busy(void)
+{
+	return _mouse_sending;
+}
+
+#else
+
+static struct SPISlave _mouse_spi_slave = { MOUSE_SLAVE_SELECT_PIN, MOUSE_SPI_CLOCK };
+
+ISR (SPI_STC_vect) // "SPI Serial Transfer Complete" interrupt (pg. 105). Only the mouse sends in the background.
+{
+	if (_mouse_packet_bytes_left) // A packet is always sent all the way through, even if another slave is waiting.
+	{
+		SPDR = _mouse_next_packet_byte();
+	}
+	else
+	{
+		SPCR                  &= ~(1 << SPIE); // "SPI Interrupt Enable" (pg. 197).
+		spi_deselect(&_mouse_spi_slave);
+		_spi_background_slave  = 0;
+	}
+}
+
+static void // Starts sending the next packet if anything is queued, the bus is free, and the ATmega32U4 is ready.
+mouse_pump(void)
+{
+	_mouse_time_packet();
+	if (_mouse_queue_head == _mouse_queue_tail || _spi_background_slave == &_mouse_spi_slave || !read_pin(MOUSE_READY_PIN))
+	{
+		return;
+	}
+
+	spi_select(&_mouse_spi_slave);
+	_mouse_begin_packet();
+	_spi_background_slave  = &_mouse_spi_slave;
+	SPDR                   = _mouse_next_packet_byte(); // Sent before the interrupt is enabled so that a leftover "SPI Interrupt Flag" can't trigger it early.
+	SPCR                  |= 1 << SPIE;
+}
+
+static bool8
+_mouse_busy(void)
+{
+	return _spi_background_slave == &_mouse_spi_slave;
+}
 
-	spi_transmit_byte((1 << 7) | (2 + direction_index_count)); // High-bit set high indicates an WordHunt packet. `2 +` is the `start_x` and `start_y` byte being sent.
-	spi_transmit_byte(start_x);
-	spi_transmit_byte(start_y);
-	for (u8 i = 0 ; i < direction_index_count; i += 1)
+#endif
+
+static bool8 // Whether the mouse has played everything it has been given.
+mouse_idle(void)
+{
+	return _mouse_queue_head == _mouse_queue_tail && !_mouse_busy() && read_pin(MOUSE_READY_PIN);
+}
+
+static void // Waits until every queued word has been sent.
+mouse_flush(void)
+{
+	while (_mouse_queue_head != _mouse_queue_tail || _mouse_busy())
 	{
-		spi_transmit_byte(direction_index_buffer[i]);
+		mouse_pump();
 	}
+}
 
+static void // Blocks only while the queue doesn't have room for the word.
+_mouse_enqueue(u8 header, const u8* prefix, u8 prefix_count, const u8* indices, u8 index_count)
+{
+	u8 word[MOUSE_WORD_MAX_SIZE] = {0};
+	u8 word_size                 = 0;
+
+	word[word_size]  = header;
+	word_size       += 1;
+	for (u8 i = 0; i < prefix_count; i += 1)
+	{
+		word[word_size]  = prefix[i];
+		word_size       += 1;
+	}
+	#if MOUSE_PACKET_VERSION == 1
+	for (u8 i = 0; i < index_count; i += 1)
+	{
+		word[word_size]  = indices[i];
+		word_size       += 1;
+	}
+	#else
+	for (u8 i = 0; i < index_count; i += 1) // Packed at 3 bits each, so an index can be split across two bytes.
+	{
+		u8 bit = i * 3;
+		word[word_size + bit / 8] |= (indices[i] & 7) << (bit % 8);
+		if (bit % 8 > 8 - 3)
+		{
+			word[word_size + bit / 8 + 1] |= (indices[i] & 7) >> (8 - bit % 8);
+		}
+	}
+	word_size += (index_count * 3 + 7) / 8;
+	#endif
+
+	while ((u8) (MOUSE_QUEUE_SIZE - 1 - ((u8) (_mouse_queue_tail - _mouse_queue_head) % MOUSE_QUEUE_SIZE)) < word_size) // Cast to `u8` first, since the difference is an `int` that goes negative once the tail wraps around.
+	{
+		mouse_pump();
+	}
+
+	u8 tail = _mouse_queue_tail;
+	for (u8 i = 0; i < word_size; i += 1)
+	{
+		_mouse_queue[tail] = word[i];
+		tail               = (tail + 1) % MOUSE_QUEUE_SIZE;
+	}
+	_mouse_queue_tail    = tail; // Only now can the next packet pick up the word.
+	_mouse_queued_words += 1;
+	_mouse_queued_steps += index_count;
+
+	mouse_pump();
+}
+
+static void
+init_mouse(void)
+{
 	set_pin(MOUSE_SLAVE_SELECT_PIN, PinState_output_high);
+	set_pin(MOUSE_READY_PIN       , PinState_input_pullup);
+
+	#if MOUSE_USART_SPI
+	UBRR1   = 0;                                         // Must be zero while the transmitter is enabled (pg. 233).
+	DDRD   |= 1 << DDD5;                                 // XCK1 as an output is what makes USART1 the master (pg. 232). Not one of `PIN_DEFS`, since it isn't broken out.
+	UCSR1C  = (1 << UMSEL11) | (1 << UMSEL10);           // "Master SPI Mode", MSB first, and SPI mode 0 like the hardware SPI (pg. 238).
+	UCSR1B  = 1 << TXEN1;                                // "Transmitter Enable" (pg. 237). Takes over TXD1 as MOSI.
+	UBRR1   = (2UL << MOUSE_SPI_CLOCK) / 2 - 1;          // The baud rate is `F_CPU / (2 * (UBRR1 + 1))` (pg. 233), so this divides `F_CPU` the same as the hardware SPI would have.
+	#endif
+}
+
+static void
+play_mouse_anagrams(i8* index_buffer, u8 word_length)
+{
+	_mouse_enqueue((0 << 7) | word_length, 0, 0, (const u8*) index_buffer, word_length); // High-bit set low indicates an Anagrams word.
+}
+
+static void
+play_mouse_wordhunt(u8 start_x, u8 start_y, u8* direction_index_buffer, u8 direction_index_count)
+{
+	#if MOUSE_PACKET_VERSION == 1
+	_mouse_enqueue((1 << 7) | (2 + direction_index_count), (u8[]) { start_x, start_y }, 2, direction_index_buffer, direction_index_count); // High-bit set high indicates a WordHunt word. `2 +` is the `start_x` and `start_y` byte being sent.
+	#else
+	_mouse_enqueue((1 << 7) | direction_index_count, (u8[]) { start_x | (start_y << 4) }, 1, direction_index_buffer, direction_index_count); // High-bit set high indicates a WordHunt word.
+	#endif
 }
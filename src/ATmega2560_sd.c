@@ -3,15 +3,44 @@
 // - "www.rjhcoding.com/avrc-sd-interface-1.php"
 // - "FatFs - Generic FAT Filesystem Module (elm-chan)"
 
-#define SD_SLAVE_SELECT_PIN  30
-#define SD_MAX_ATTEMPTS      10000
-#define SD_SECTOR_SIZE_LOG2  9                          // The 2's exponent for the size of data-blocks for reading and writing to the SD card. This is asserted, so SD cards with different sized data-blocks are incompatible.
-#define SD_SECTOR_SIZE       (1 << SD_SECTOR_SIZE_LOG2) // `2^9` is 512, so sectors in the SD card should be 512 bytes.
-#define SD_SPI_IDLE_FLAG     0x1
-#define SD_SPI_NULL_TOKEN    0xFF                       // Value used to send and receive from SD card when not sending useful information.
-#define SD_SPI_START_TOKEN   0xFE                       // Indicates the start of a data-block for both receiving or transmitting.
-
-static bool8 _sd_inited = false;
+#define SD_SLAVE_SELECT_PIN      30
+#define SD_MAX_ATTEMPTS          10000
+#define SD_SECTOR_SIZE_LOG2      9                          // The 2's exponent for the size of data-blocks for reading and writing to the SD card. This is asserted, so SD cards with different sized data-blocks are incompatible.
+#define SD_SECTOR_SIZE           (1 << SD_SECTOR_SIZE_LOG2) // `2^9` is 512, so sectors in the SD card should be 512 bytes.
+#define SD_SPI_IDLE_FLAG         0x1
+#define SD_SPI_NULL_TOKEN        0xFF                       // Value used to send and receive from SD card when not sending useful information.
+#define SD_SPI_START_TOKEN       0xFE                       // Indicates the start of a data-block for both receiving or transmitting.
+#define SD_SPI_MULTI_START_TOKEN 0xFC                       // Indicates the start of a data-block being transmitted with "CMD25".
+#define SD_SPI_STOP_TOKEN        0xFD                       // Ends the data-blocks being transmitted with "CMD25".
+#define SD_BUSY_TIMEOUT_MS       500                        // SD cards can take up to 250ms to program a data-block, so this is doubled just to be safe.
+#define SD_SPI_INIT_CLOCK        SPIClock_div32             // 500kHz; SD card must be initialized at a slow clock ("elm-chan").
+#define SD_SPI_DATA_CLOCK        SPIClock_div2              // 8MHz; fastest the SPI can go, which is attempted once the SD card is initialized.
+#define SD_CLOCK_RESTORE_COUNT   64                         // Sectors of requests that went through cleanly at a fallen-back clock before the next faster clock is tried again.
+#define SD_CACHE_SECTOR_COUNT    1                          // Sectors kept in RAM by the cache under `disk_read` and `disk_write`. Each costs 512 bytes of RAM, and there must be atleast one. More only fits if the stack has room to spare.
+#define SD_CACHE_NO_SECTOR       ((LBA_t) -1)
+#define SD_WINDOW_SLACK          16                         // Bytes in front of a `SDWindow`'s sector for carrying over a record that straddles two sectors. This is the largest record that can be taken at once.
+
+enum SDStream
+{
+	SDStream_none,
+	SDStream_read, // "CMD18" is in progress; the SD card sends consecutive data-blocks until "CMD12" is sent.
+	SDStream_write // "CMD25" is in progress; the SD card takes consecutive data-blocks until the stop token is sent.
+};
+
+static          struct SPISlave       _sd_spi_slave               = { SD_SLAVE_SELECT_PIN, SD_SPI_INIT_CLOCK };
+static          bool8                 _sd_inited                  = false;
+static          enum SPIClock         _sd_data_clock              = SD_SPI_INIT_CLOCK; // Fastest clock that `disk_initialize` found the SD card to work at.
+static          u8                    _sd_failure_count           = 0;                 // Failed transfers in a row at the current clock.
+static          u8                    _sd_clean_count             = 0;                 // Clean transfers in a row since the clock last changed.
+static          enum SDStream         _sd_stream                  = SDStream_none; // Streams are kept open across `disk_read` and `disk_write` calls so that sequential accesses don't pay for a command per sector.
+static          LBA_t                 _sd_stream_sector           = 0;             // The sector that the open stream will transfer next.
+static          bool8                 _sd_busy                    = false;         // The SD card is still programming a data-block (or finishing "CMD12") and will hold MISO low until it is done.
+static          u8                    _sd_cache_data    [SD_CACHE_SECTOR_COUNT][SD_SECTOR_SIZE];
+static          LBA_t                 _sd_cache_sectors [SD_CACHE_SECTOR_COUNT];
+static          u8                    _sd_cache_recency [SD_CACHE_SECTOR_COUNT];             // Indices into the cache ordered from the most to least recently used.
+static          u32                   _sd_cache_hits              = 0;
+static          u32                   _sd_cache_misses            = 0;
+static          LBA_t                 _sd_last_sector             = SD_CACHE_NO_SECTOR; // Most recently accessed sector, used to tell whether or not an access continues a sequential run.
 
 static void
 _sd_print_response_breakdown(i8 cmd, u8 response)
@@ -69,11 +98,8 @@ _sd_receive_data_block(u8* buffer, i16 amount)
 	return response;
 }
 
-// `0` is the optimal return value as it means the SD card recieved the response.
-// `1` suggests that the SD card is in idle mode.
-// Otherwise there is likely an error.
-static u8
-_sd_transmit_command(u8 cmd, u32 args)
+static void
+_sd_transmit_command_frame(u8 cmd, u32 args)
 {
 	spi_transmit_byte((1 << 6) | cmd);
 	spi_transmit_byte((args >> 24) & 0xFF);
@@ -85,7 +111,11 @@ _sd_transmit_command(u8 cmd, u32 args)
 		cmd == 0 ? 0x95 :
 		cmd == 8 ? 0x87 : 0xFF
 	);
+}
 
+static u8
+_sd_receive_response(void)
+{
 	u8 response = spi_receive_byte();
 	for (i8 i = 0; i < 8 && (response & (1 << 7)); i += 1) // SD card should respond within 8 ticks.
 	{
@@ -94,12 +124,146 @@ _sd_transmit_command(u8 cmd, u32 args)
 	return response;
 }
 
-static u8 // Returning `SD_SPI_START_TOKEN` suggests that the procedure was successful in receiving the data-block of the SD card's contents, otherwise there's likely an error.
-_sd_read(u8* buffer, u32 address)
+// `0` is the optimal return value as it means the SD card recieved the response.
+// `1` suggests that the SD card is in idle mode.
+// Otherwise there is likely an error.
+static u8
+_sd_transmit_command(u8 cmd, u32 args)
+{
+	_sd_transmit_command_frame(cmd, args);
+	return _sd_receive_response();
+}
+
+static u8 // Returns `0` once the SD card is done being busy, otherwise `SD_SPI_NULL_TOKEN` if it took too long. The SD card must already be selected.
+_sd_wait_until_ready(void)
+{
+	if (_sd_busy)
+	{
+		u32 starting_time_ms = get_ms();
+		while (spi_receive_byte() != SD_SPI_NULL_TOKEN) // SD card holds the line low while it is busy.
+		{
+			if (get_ms() - starting_time_ms >= SD_BUSY_TIMEOUT_MS)
+			{
+				return SD_SPI_NULL_TOKEN;
+			}
+		}
+		_sd_busy = false;
+	}
+
+	return 0;
+}
+
+static u8 // Returns `0` on success, otherwise likely an error.
+_sd_stop_stream(void)
+{
+	u8 response = 0;
+
+	switch (_sd_stream)
+	{
+		case SDStream_none:
+		{
+		} break;
+
+		case SDStream_read:
+		{
+			spi_select(&_sd_spi_slave);
+
+			_sd_transmit_command_frame(12, 0); // "CMD12" stops the transmission of data-blocks.
+			spi_receive_byte();                // The byte right after "CMD12" is a stuff byte that could be mistaken for a response.
+			response = _sd_receive_response();
+			_sd_busy = true;                   // "CMD12" has a busy signal that'll be waited on by whatever talks to the SD card next.
+
+			spi_deselect(&_sd_spi_slave);
+		} break;
+
+		case SDStream_write:
+		{
+			spi_select(&_sd_spi_slave);
+
+			response = _sd_wait_until_ready();
+			if (!response)
+			{
+				spi_transmit_byte(SD_SPI_STOP_TOKEN);
+				spi_receive_byte(); // A byte is skipped before the SD card begins signaling that it is busy.
+				_sd_busy = true;
+			}
+
+			spi_deselect(&_sd_spi_slave);
+		} break;
+	}
+
+	_sd_stream = SDStream_none;
+
+	return response;
+}
+
+static u8 // Returns `0` on success, otherwise likely an error.
+_sd_start_read_stream(u32 address)
 {
-	set_pin(SD_SLAVE_SELECT_PIN, PinState_output_low);
+	u8 response = _sd_stop_stream();
+	if (response)
+	{
+		return response;
+	}
+
+	spi_select(&_sd_spi_slave);
+	response = _sd_wait_until_ready();
+	if (!response)
+	{
+		response = _sd_transmit_command(18, address);
+	}
+	spi_deselect(&_sd_spi_slave);
 
-	u8 response = _sd_transmit_command(17, address);
+	if (!response)
+	{
+		_sd_stream        = SDStream_read;
+		_sd_stream_sector = address;
+	}
+
+	return response;
+}
+
+//
+// Data-blocks are read by polling rather than in the background from "ISR (SPI_STC_vect)". At `SD_SPI_DATA_CLOCK` a byte
+// takes 16 cycles, which is less than an interrupt takes just to enter and return, so reading in an interrupt would be
+// slower than this loop and would only give the search the little time left between bytes. It also took a 512-byte
+// buffer of RAM for every data-block read ahead. Only the mouse sends from the SPI interrupt, since its bytes go out at a
+// slow clock.
+//
+
+static u8 // Returning `SD_SPI_START_TOKEN` suggests that the next data-block of the open read stream has been received, otherwise there's likely an error.
+_sd_read_stream(u8* buffer)
+{
+	spi_select(&_sd_spi_slave);
+
+	u8 response = _sd_receive_data_block(buffer, SD_SECTOR_SIZE);
+	if (response == SD_SPI_START_TOKEN)
+	{
+		spi_receive_byte(); // 16-bit CRC sent for error-checking that we are ignoring.
+		spi_receive_byte();
+		_sd_stream_sector += 1;
+	}
+
+	spi_deselect(&_sd_spi_slave);
+
+	return response;
+}
+
+static u8 // Returning `SD_SPI_START_TOKEN` suggests that the data-block was received with "CMD17", otherwise there's likely an error.
+_sd_read_single(u8* buffer, u32 address)
+{
+	u8 response = _sd_stop_stream();
+	if (response)
+	{
+		return response;
+	}
+
+	spi_select(&_sd_spi_slave);
+	response = _sd_wait_until_ready();
+	if (!response)
+	{
+		response = _sd_transmit_command(17, address);
+	}
 	if (!response)
 	{
 		response = _sd_receive_data_block(buffer, SD_SECTOR_SIZE);
@@ -107,28 +271,64 @@ _sd_read(u8* buffer, u32 address)
 		{
 			spi_receive_byte(); // 16-bit CRC sent for error-checking that we are ignoring.
 			spi_receive_byte();
+		}
+	}
+	spi_deselect(&_sd_spi_slave);
+
+	return response;
+}
+
+static u8 // Returns `0` on success, otherwise likely an error.
+_sd_start_write_stream(u32 address, u32 pre_erase_count)
+{
+	u8 response = _sd_stop_stream();
+	if (response)
+	{
+		return response;
+	}
 
+	spi_select(&_sd_spi_slave);
+	response = _sd_wait_until_ready();
+	if (!response && pre_erase_count > 1)
+	{
+		// "ACMD23" hints the amount of data-blocks that are about to be written so the SD card can erase them all at once.
+		// Data-blocks that were pre-erased but never written end up with undefined contents, so this should never be more than what's actually written.
+		response = _sd_transmit_command(55, 0);
+		if (!response)
+		{
+			response = _sd_transmit_command(23, pre_erase_count);
 		}
 	}
+	if (!response)
+	{
+		response = _sd_transmit_command(25, address);
+	}
+	spi_deselect(&_sd_spi_slave);
 
-	set_pin(SD_SLAVE_SELECT_PIN, PinState_output_high);
+	if (!response)
+	{
+		_sd_stream        = SDStream_write;
+		_sd_stream_sector = address;
+	}
 
 	return response;
 }
 
 static u8 // Returns `0` on success, otherwise likely an error.
-_sd_write(const u8* buffer, u32 address)
+_sd_write_stream(const u8* buffer)
 {
-	set_pin(SD_SLAVE_SELECT_PIN, PinState_output_low);
+	spi_select(&_sd_spi_slave);
 
-	u8 response = _sd_transmit_command(24, address);
+	u8 response = _sd_wait_until_ready(); // The previous data-block is programmed while we were off doing something else.
 	if (!response)
 	{
-		spi_transmit_byte(SD_SPI_START_TOKEN);
+		spi_transmit_byte(SD_SPI_MULTI_START_TOKEN);
 		for (i16 i = 0; i < SD_SECTOR_SIZE; i += 1)
 		{
 			spi_transmit_byte(buffer[i]);
 		}
+		spi_transmit_byte(0xFF); // 16-bit CRC that is ignored by the SD card.
+		spi_transmit_byte(0xFF);
 
 		u16 attempts_left = SD_MAX_ATTEMPTS;
 		do
@@ -143,22 +343,149 @@ _sd_write(const u8* buffer, u32 address)
 		// `0x???01101` : rejected due to write error.
 		if ((response & 0xF) == 0x5)
 		{
-			attempts_left = SD_MAX_ATTEMPTS;
-			do
-			{
-				response       = spi_receive_byte(); // SD card will send `0` to indicate it is busy writing the data.
-				attempts_left -= 1;
-			}
-			while (!response && attempts_left);
-			return response == SD_SPI_NULL_TOKEN ? 0 : response;
+			response           = 0;
+			_sd_busy           = true; // Rather than waiting for the SD card to finish programming, the wait is deferred to the next time the SD card is selected.
+			_sd_stream_sector += 1;
 		}
 	}
 
-	set_pin(SD_SLAVE_SELECT_PIN, PinState_output_high);
+	spi_deselect(&_sd_spi_slave);
 
 	return response;
 }
 
+static u8 // Returns `0` once all data-blocks are fully written to the SD card, otherwise likely an error.
+_sd_sync(void)
+{
+	u8 response = _sd_stop_stream();
+	if (!response)
+	{
+		spi_select(&_sd_spi_slave);
+		response = _sd_wait_until_ready();
+		spi_deselect(&_sd_spi_slave);
+	}
+	return response;
+}
+
+//
+// Sectors accessed out of sequence (FAT entries, the header of "BANK.BIN", a word being looked up again, etc.) tend to be accessed again soon,
+// so the most recently used ones are kept in RAM. Sequential runs are left to the streams so they don't push everything else out of the cache.
+// The cache is write-through, so the SD card is always up to date.
+//
+
+static void
+_sd_invalidate_cache(void)
+{
+	for (u8 i = 0; i < SD_CACHE_SECTOR_COUNT; i += 1)
+	{
+		_sd_cache_sectors[i] = SD_CACHE_NO_SECTOR;
+		_sd_cache_recency[i] = i;
+	}
+	_sd_last_sector = SD_CACHE_NO_SECTOR;
+}
+
+static u8 // Moves the entry at `recency_index` to be the most recently used and returns its index into the cache.
+_sd_touch_cache(u8 recency_index)
+{
+	u8 index = _sd_cache_recency[recency_index];
+	memmove(_sd_cache_recency + 1, _sd_cache_recency, recency_index);
+	_sd_cache_recency[0] = index;
+	return index;
+}
+
+static u8* // Returns the cached copy of `sector`, otherwise `0`.
+_sd_find_cached(LBA_t sector)
+{
+	for (u8 i = 0; i < SD_CACHE_SECTOR_COUNT; i += 1)
+	{
+		if (_sd_cache_sectors[_sd_cache_recency[i]] == sector)
+		{
+			return _sd_cache_data[_sd_touch_cache(i)];
+		}
+	}
+	return 0;
+}
+
+static void // Evicts the least recently used sector.
+_sd_cache(LBA_t sector, const u8* data)
+{
+	u8 index = _sd_touch_cache(SD_CACHE_SECTOR_COUNT - 1);
+	_sd_cache_sectors[index] = sector;
+	memcpy(_sd_cache_data[index], data, SD_SECTOR_SIZE);
+}
+
+static void // Reports through UART how the cache has been doing since the last report.
+sd_report_cache(void)
+{
+	uart_send_pstr("SD cache had ");
+	uart_send_u64(_sd_cache_hits);
+	uart_send_pstr(" hits and ");
+	uart_send_u64(_sd_cache_misses);
+	uart_send_pstr(" misses (");
+	uart_send_u64(SD_CACHE_SECTOR_COUNT);
+	uart_send_pstr(" sectors).\n");
+
+	_sd_cache_hits   = 0;
+	_sd_cache_misses = 0;
+}
+
+//
+// A single failed request is likely just noise, so it's retried at the same clock. Only when it fails again does the clock fall back,
+// and once enough requests have gone through cleanly at the slower clock, the next faster one (up to `_sd_data_clock`) is tried again.
+// A request can only be retried twice at each clock, so one that keeps failing gives up once it fails at `SD_SPI_INIT_CLOCK`.
+//
+
+static bool8 // Returns whether or not the failed transfer should be retried.
+_sd_retry_failure(void)
+{
+	_sd_clean_count = 0;
+
+	if (!_sd_failure_count)
+	{
+		_sd_failure_count = 1;
+		return true;
+	}
+	else if (_sd_spi_slave.clock < SD_SPI_INIT_CLOCK)
+	{
+		_sd_failure_count    = 0;
+		_sd_spi_slave.clock += 1;
+
+		uart_send_pstr("Falling back to an SPI clock of F_CPU/");
+		uart_send_u64(2 << _sd_spi_slave.clock);
+		uart_send_pstr(" for the SD card.\n");
+
+		return true;
+	}
+	else
+	{
+		_sd_failure_count = 0;
+		return false;
+	}
+}
+
+static void // Only called once a whole request is done, since a failure partway through redoes the request from its first sector and mustn't look like a first failure each time.
+_sd_count_clean_request(UINT sector_count)
+{
+	_sd_failure_count = 0;
+
+	if (_sd_spi_slave.clock > _sd_data_clock)
+	{
+		if (sector_count < (UINT) (SD_CLOCK_RESTORE_COUNT - _sd_clean_count))
+		{
+			_sd_clean_count += sector_count;
+		}
+		else
+		{
+			_sd_clean_count      = 0;
+			_sd_spi_slave.clock -= 1;
+
+			uart_send_pstr("Going back up to an SPI clock of F_CPU/");
+			uart_send_u64(2 << _sd_spi_slave.clock);
+			uart_send_pstr(" for the SD card.\n");
+		}
+	}
+}
+
 static bool8
 sd_fwrite(FIL* file, void* buffer, u16 size)
 {
@@ -173,6 +500,114 @@ sd_fread(FIL* file, void* buffer, u16 size)
 	return f_read(file, buffer, size, &read_amount) == FR_OK && read_amount == size;
 }
 
+static bool8 // Returns whether or not seeking `file` now uses `link_map` instead of following the cluster chain from the beginning. `link_map` must stay around for as long as the file is open.
+sd_enable_fast_seek(FIL* file, DWORD* link_map, u16 link_map_length)
+{
+	#if FF_USE_FASTSEEK
+		file->cltbl = link_map;
+		link_map[0] = link_map_length;
+
+		FRESULT result = f_lseek(file, CREATE_LINKMAP); // The file's position is left untouched.
+		if (result == FR_OK)
+		{
+			return true;
+		}
+		else
+		{
+			if (result == FR_NOT_ENOUGH_CORE)
+			{
+				uart_send_pstr("File is too fragmented for fast-seek; link map needs ");
+				uart_send_u64(link_map[0]);
+				uart_send_pstr(" entries.\n");
+			}
+			file->cltbl = 0;
+			return false;
+		}
+	#else
+		return false; // `FF_USE_FASTSEEK` should be defined to be `1` for this.
+	#endif
+}
+
+//
+// A `SDWindow` reads a file a sector at a time and hands out pointers straight into that sector, so reading lots of tiny records doesn't go through FatFs for each one.
+// Once the window is aligned to the file's sectors, FatFs transfers each sector directly into the window rather than into its own buffer first.
+//
+
+struct SDWindow
+{
+	FIL* file;
+	u16  cursor;                                              // Index of the next byte in `buffer` to be taken.
+	u16  end;                                                 // Index just past the last valid byte in `buffer`.
+	u8   buffer[SD_WINDOW_SLACK + SD_SECTOR_SIZE + sizeof(u16)]; // The extra bytes at the end let a record at the very end of the sector still be read as whole `u16`s.
+};
+
+static void // The window begins at wherever `file` currently is.
+sd_window_open(struct SDWindow* window, FIL* file)
+{
+	window->file   = file;
+	window->cursor = SD_WINDOW_SLACK;
+	window->end    = SD_WINDOW_SLACK;
+}
+
+static u32
+sd_window_tell(struct SDWindow* window)
+{
+	return f_tell(window->file) - (window->end - window->cursor);
+}
+
+static bool8 // Returns whether or not any new bytes were read into the window.
+_sd_window_refill(struct SDWindow* window)
+{
+	u16 leftover = window->end - window->cursor;
+	u16 offset   = f_tell(window->file) % SD_SECTOR_SIZE; // Only nonzero for the first read after opening or skipping; the rest are whole sectors.
+
+	memmove(window->buffer + SD_WINDOW_SLACK + offset - leftover, window->buffer + window->cursor, leftover);
+
+	u16 read_amount;
+	if (f_read(window->file, window->buffer + SD_WINDOW_SLACK + offset, SD_SECTOR_SIZE - offset, &read_amount))
+	{
+		return false;
+	}
+
+	window->cursor = SD_WINDOW_SLACK + offset - leftover;
+	window->end    = SD_WINDOW_SLACK + offset + read_amount;
+
+	return read_amount != 0;
+}
+
+static u8* // Returns a pointer to the next `size` bytes of the file which stays valid until the window is used again, otherwise `0` if there aren't enough bytes left. `size` must not exceed `SD_WINDOW_SLACK`.
+sd_window_take(struct SDWindow* window, u8 size)
+{
+	while (window->end - window->cursor < size)
+	{
+		if (!_sd_window_refill(window))
+		{
+			return 0;
+		}
+	}
+
+	u8* bytes       = window->buffer + window->cursor;
+	window->cursor += size;
+	return bytes;
+}
+
+static bool8
+sd_window_skip(struct SDWindow* window, u32 amount)
+{
+	if (amount <= (u32) (window->end - window->cursor))
+	{
+		window->cursor += amount;
+		return true;
+	}
+	else
+	{
+		u32 position   = sd_window_tell(window) + amount;
+		window->cursor = SD_WINDOW_SLACK;
+		window->end    = SD_WINDOW_SLACK;
+		return f_lseek(window->file, position) == FR_OK;
+	}
+}
+
 DSTATUS
 disk_status(BYTE pdrv)
 {
@@ -184,7 +619,16 @@ disk_initialize(BYTE pdrv)
 {
 	if (pdrv == 0)
 	{
-		set_pin(SD_SLAVE_SELECT_PIN, PinState_output_high);
+		_sd_spi_slave.clock = SD_SPI_INIT_CLOCK;
+		_sd_failure_count   = 0;
+		_sd_clean_count     = 0;
+		spi_deselect(&_sd_spi_slave);
+		spi_set_clock(SD_SPI_INIT_CLOCK);
+
+		_sd_invalidate_cache();
+		_sd_inited = false;
+		_sd_stream = SDStream_none;
+		_sd_busy   = false;
 
 		_delay_ms(1.0);                // For powering up; redundant, but just in case.
 		for (i8 i = 0; i < 10; i += 1) // Send atleast 72 clock pulses to ready the SPI communication with the SD card.
@@ -192,7 +636,7 @@ disk_initialize(BYTE pdrv)
 			spi_transmit_byte(0xFF);
 		}
 
-		set_pin(SD_SLAVE_SELECT_PIN, PinState_output_low); // SD card enters SPI mode.
+		spi_select(&_sd_spi_slave); // SD card enters SPI mode.
 
 		{ // "CMD0" sets the SD card to the idle state.
 			u8  response;
@@ -250,6 +694,7 @@ disk_initialize(BYTE pdrv)
 				return STA_NOINIT;
 			}
 		}
+		u8 csd_register[16];
 		{ // "CMD9" reads the SD card's CSD register which contains useful information like the block size.
 			u8 response = _sd_transmit_command(9, 0);
 			if (response)
@@ -258,10 +703,12 @@ disk_initialize(BYTE pdrv)
 				return STA_NOINIT;
 			}
 
-			u8 csd_register[16];
 			response = _sd_receive_data_block(csd_register, countof(csd_register));
 			if (response == SD_SPI_START_TOKEN)
 			{
+				spi_receive_byte(); // 16-bit CRC sent for error-checking that we are ignoring.
+				spi_receive_byte();
+
 				u8 max_read_data_block_length = csd_register[countof(csd_register) - 1 - 80 / 8] & 0xF; // Grabs bits in interval [80, 84) which should have the value `SD_SECTOR_SIZE_LOG2` which is commonly 512 bytes.
 				if (max_read_data_block_length != SD_SECTOR_SIZE_LOG2)
 				{
@@ -280,9 +727,40 @@ disk_initialize(BYTE pdrv)
 			}
 		}
 
-		_sd_inited = true;
+		spi_deselect(&_sd_spi_slave); // Release SD card from SPI channel.
 
-		set_pin(SD_SLAVE_SELECT_PIN, PinState_output_high); // Release SD card from SPI channel.
+		//
+		// Data-blocks can be transferred at a much faster clock than what initialization requires, but the SD card (or the wiring to it) might not keep up,
+		// so the CSD register is reread at increasingly slower clocks until it matches what was read at the initialization clock.
+		//
+
+		for (_sd_spi_slave.clock = SD_SPI_DATA_CLOCK; _sd_spi_slave.clock < SD_SPI_INIT_CLOCK; _sd_spi_slave.clock += 1)
+		{
+			u8 csd_register_reread[countof(csd_register)];
+
+			spi_select(&_sd_spi_slave);
+			u8 response = _sd_transmit_command(9, 0);
+			if (!response)
+			{
+				response = _sd_receive_data_block(csd_register_reread, countof(csd_register_reread));
+				spi_receive_byte(); // 16-bit CRC sent for error-checking that we are ignoring.
+				spi_receive_byte();
+			}
+			spi_deselect(&_sd_spi_slave);
+
+			if (response == SD_SPI_START_TOKEN && !memcmp(csd_register, csd_register_reread, sizeof(csd_register)))
+			{
+				break;
+			}
+		}
+
+		_sd_data_clock = _sd_spi_slave.clock;
+
+		uart_send_pstr("SD card is using an SPI clock of F_CPU/");
+		uart_send_u64(2 << _sd_spi_slave.clock);
+		uart_send_pstr(".\n");
+
+		_sd_inited = true;
 
 		return 0;
 	}
@@ -297,17 +775,67 @@ disk_read(BYTE pdrv, BYTE* buff, LBA_t sector, UINT count)
 {
 	if (pdrv == 0)
 	{
+		RETRY:;
+
 		for (UINT i = 0; i < count; i += 1)
 		{
-			u8 response = _sd_read(buff + SD_SECTOR_SIZE * i, sector + i);
+			bool8 in_sequence = sector + i == _sd_last_sector + 1;
+			_sd_last_sector   = sector + i;
+
+			u8* cached = _sd_find_cached(sector + i);
+			if (cached)
+			{
+				memcpy(buff + SD_SECTOR_SIZE * i, cached, SD_SECTOR_SIZE);
+				_sd_cache_hits += 1;
+				continue;
+			}
+			_sd_cache_misses += 1;
+
+			u8 response;
+			if (_sd_stream == SDStream_read && _sd_stream_sector == sector + i)
+			{
+				response = _sd_read_stream(buff + SD_SECTOR_SIZE * i);
+			}
+			else if (in_sequence || i + 1 < count) // A "CMD18" only pays off once it's clear that the sectors are being read one after another.
+			{
+				response = _sd_start_read_stream(sector + i);
+				if (response)
+				{
+					_sd_print_response_breakdown(18, response);
+					if (_sd_retry_failure())
+					{
+						goto RETRY;
+					}
+					return RES_ERROR;
+				}
+
+				response = _sd_read_stream(buff + SD_SECTOR_SIZE * i);
+			}
+			else // Otherwise a single "CMD17" doesn't leave a stream open that'd need a "CMD12" (and its busy signal) later.
+			{
+				response = _sd_read_single(buff + SD_SECTOR_SIZE * i, sector + i);
+			}
+
 			if (response != SD_SPI_START_TOKEN)
 			{
-				uart_send_pstr("Failed to read data-block of SD contents for CMD17 (received response of `0b");
+				uart_send_pstr("Failed to read data-block of SD contents (received response of `0b");
 				uart_send_b8(response);
 				uart_send_pstr("`).\n");
+				_sd_stop_stream();
+				if (_sd_retry_failure()) // The whole request is redone since the stream was stopped.
+				{
+					goto RETRY;
+				}
 				return RES_ERROR;
 			}
+
+			if (!in_sequence)
+			{
+				_sd_cache(sector + i, buff + SD_SECTOR_SIZE * i);
+			}
 		}
+
+		_sd_count_clean_request(count);
 		return RES_OK;
 	}
 	else
@@ -321,18 +849,51 @@ disk_write(BYTE pdrv, const BYTE* buff, LBA_t sector, UINT count)
 {
 	if (pdrv == 0)
 	{
+		RETRY:;
+
+		if (_sd_stream != SDStream_write || _sd_stream_sector != sector) // Only a non-contiguous request costs a new "CMD25" (and possibly "ACMD23").
+		{
+			u8 response = _sd_start_write_stream(sector, count);
+			if (response)
+			{
+				_sd_print_response_breakdown(25, response);
+				if (_sd_retry_failure())
+				{
+					goto RETRY;
+				}
+				return RES_ERROR;
+			}
+		}
+
 		for (UINT i = 0; i < count; i += 1)
 		{
-			u8 response = _sd_write(buff + SD_SECTOR_SIZE * i, sector + i); // CMD25 to write multiple data-blocks could be used here instead.
+			u8 response = _sd_write_stream(buff + SD_SECTOR_SIZE * i);
 			if (response)
 			{
-				uart_send_pstr("Failed to write data-block of SD contents for CMD24 (received response of `0b");
+				uart_send_pstr("Failed to write data-block of SD contents for CMD25 (received response of `0b");
 				uart_send_b8(response);
 				uart_send_pstr("`)\n");
+				_sd_stop_stream();
+				if (_sd_retry_failure()) // The whole request is redone since the stream was stopped.
+				{
+					goto RETRY;
+				}
 				return RES_ERROR;
 			}
+
+			u8* cached = _sd_find_cached(sector + i);
+			if (cached)
+			{
+				memcpy(cached, buff + SD_SECTOR_SIZE * i, SD_SECTOR_SIZE);
+			}
+			else if (sector + i != _sd_last_sector + 1)
+			{
+				_sd_cache(sector + i, buff + SD_SECTOR_SIZE * i);
+			}
+			_sd_last_sector = sector + i;
 		}
 
+		_sd_count_clean_request(count);
 		return RES_OK;
 	}
 
@@ -348,7 +909,7 @@ disk_ioctl(BYTE pdrv, BYTE cmd, void* buff)
 		{
 			case CTRL_SYNC:
 			{
-				return RES_OK; // The SD card does need to be flushed.
+				return _sd_sync() ? RES_ERROR : RES_OK; // Data-blocks of an open "CMD25" aren't guaranteed to be written until the stream is stopped and the SD card is no longer busy.
 			} break;
 
 			case GET_SECTOR_COUNT:
@@ -1,3 +1,51 @@
+// Refer to:
+// - "ATmega2560 Datasheet" ("(pg. N)" refers to page number `N` of this resource)
+
+enum SPIClock // Ordered from fastest to slowest, so falling back to a slower clock is just an increment. The SPI clock frequency is `F_CPU / (2 << clock)`.
+{
+	SPIClock_div2,
+	SPIClock_div4,
+	SPIClock_div8,
+	SPIClock_div16,
+	SPIClock_div32,
+	SPIClock_div64,
+	SPIClock_div128,
+	SPIClock_COUNT
+};
+
+static const u8 SPI_CLOCK_BITS[SPIClock_COUNT] PROGMEM = // Bits 1 and 0 are "SPR1" and "SPR0" of the "SPI Control Register" and bit 2 is the "Double SPI Speed Bit" (pg. 198).
+	{
+		(1 << 2) | (0 << 1) | (0 << 0),
+		(0 << 2) | (0 << 1) | (0 << 0),
+		(1 << 2) | (0 << 1) | (1 << 0),
+		(0 << 2) | (0 << 1) | (1 << 0),
+		(1 << 2) | (1 << 1) | (0 << 0),
+		(0 << 2) | (1 << 1) | (0 << 0),
+		(0 << 2) | (1 << 1) | (1 << 0)
+	};
+
+struct SPISlave // Each device on the bus remembers its own clock, so the bus is reconfigured whenever a different device is selected.
+{
+	u8            slave_select_pin;
+	enum SPIClock clock;
+};
+
+static enum SPIClock             _spi_clock            = SPIClock_COUNT;
+static struct SPISlave* volatile _spi_background_slave = 0; // Slave that currently owns the bus for an interrupt-driven transfer.
+
+static void
+spi_set_clock(enum SPIClock clock)
+{
+	if (_spi_clock != clock)
+	{
+		_spi_clock = clock;
+
+		u8 bits = pgm_read_byte(&SPI_CLOCK_BITS[clock]);
+		SPCR = (SPCR & ~((1 << SPR1) | (1 << SPR0))) | (bits & 3); // "SPI Clock Rate Select" (pg. 198).
+		SPSR = ((bits >> 2) & 1) << SPI2X;                         // "Double SPI Speed Bit"  (pg. 198). The rest of the register is read-only.
+	}
+}
+
 static void
 init_spi(void)
 {
@@ -11,11 +59,34 @@ init_spi(void)
 
 	SPCR |=                        // "SPI Control Register"  (pg. 197).
 		(1 << SPE)  |              // "SPI Enable"            (pg. 197).
-		(1 << MSTR) |              // "Master/Slave Select"   (pg. 197).
-		(1 << SPR1) | (0 << SPR0); // "SPI Clock Rate Select" (pg. 198). The speed is later set to be doubled by the "Double SPI Speed Bit". Frequency should be between 100kHz and 400kHz for the SD card ("elm-chan").
+		(1 << MSTR);               // "Master/Slave Select"   (pg. 197).
+
+	spi_set_clock(SPIClock_div32); // Frequency should be between 100kHz and 400kHz for the SD card to initialize ("elm-chan"); devices select their own clock afterwards.
+}
+
+static void
+spi_select(struct SPISlave* slave)
+{
+	while (_spi_background_slave && _spi_background_slave != slave); // An interrupt-driven transfer always runs until it's done.
+
+	spi_set_clock(slave->clock);
+	#if MOUSE_USART_SPI // `set_pin` reads and writes back all of "PORTC", so the mouse's chip-select being raised by its interrupt in between would get undone.
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	#endif
+	{
+		set_pin(slave->slave_select_pin, PinState_output_low);
+	}
+}
 
-	SPSR |=                        // "SPI Status Register"   (pg. 198).
-		(1 << SPI2X);              // "Double SPI Speed Bit"  (pg. 198)
+static void
+spi_deselect(struct SPISlave* slave)
+{
+	#if MOUSE_USART_SPI
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	#endif
+	{
+		set_pin(slave->slave_select_pin, PinState_output_high);
+	}
 }
 
 static void